@@ -0,0 +1,91 @@
+#include "log.h"
+#include "utils.h"
+#include "auto_input.h"
+
+namespace dentra {
+namespace tion {
+namespace auto_co2 {
+
+static const char *const TAG = "tion-api-auto";
+
+void AutoInputPipeline::set_sensor(AutoSensor sensor, float setpoint) {
+  if (sensor >= AUTO_SENSOR_COUNT) {
+    return;
+  }
+  this->sensors_[sensor].setpoint = setpoint;
+}
+
+void AutoInputPipeline::set_smoothing(float alpha) {
+  if (!(alpha > 0.0f && alpha <= 1.0f)) {
+    TION_LOGW(TAG, "Invalid smoothing %f", alpha);
+    return;
+  }
+  for (auto &&sensor : this->sensors_) {
+    sensor.filter.set_alpha(alpha);
+  }
+}
+
+void AutoInputPipeline::set_median_window(uint8_t window) {
+  if (window == 0 || window > TION_AUTO_MEDIAN_WINDOW) {
+    TION_LOGW(TAG, "Invalid median window %u", window);
+    return;
+  }
+  for (auto &&sensor : this->sensors_) {
+    sensor.filter.set_window(window);
+  }
+}
+
+void AutoInputPipeline::update(AutoSensor sensor, float value) {
+  if (sensor >= AUTO_SENSOR_COUNT || std::isnan(value)) {
+    return;
+  }
+  auto &input = this->sensors_[sensor];
+  if (sensor != AUTO_SENSOR_CO2 && input.setpoint <= 0) {
+    return;
+  }
+  // old samples must not affect fresh data
+  if (this->is_stale(sensor)) {
+    input.filter.reset();
+  }
+  input.last_update = tion::millis();
+  const float res = input.filter.update(value);
+  TION_LOGV(TAG, "Sensor %u: %f -> %f", sensor, value, res);
+}
+
+uint16_t AutoInputPipeline::demand(uint16_t co2_setpoint) const {
+  float res = 0;
+  for (uint8_t i = 0; i < AUTO_SENSOR_COUNT; i++) {
+    const auto sensor = static_cast<AutoSensor>(i);
+    const float value = this->get_value(sensor);
+    if (std::isnan(value)) {
+      continue;
+    }
+    const float demand = sensor == AUTO_SENSOR_CO2 ? value : co2_setpoint * value / this->sensors_[i].setpoint;
+    if (demand > res) {
+      res = demand;
+    }
+  }
+  return res < UINT16_MAX ? static_cast<uint16_t>(res) : UINT16_MAX;
+}
+
+float AutoInputPipeline::get_value(AutoSensor sensor) const {
+  if (this->is_stale(sensor)) {
+    return NAN;
+  }
+  return this->sensors_[sensor].filter.value();
+}
+
+bool AutoInputPipeline::is_stale(AutoSensor sensor) const {
+  if (sensor >= AUTO_SENSOR_COUNT) {
+    return true;
+  }
+  const auto &input = this->sensors_[sensor];
+  if (input.filter.size() == 0) {
+    return true;
+  }
+  return this->timeout_ > 0 && tion::millis() - input.last_update > this->timeout_;
+}
+
+}  // namespace auto_co2
+}  // namespace tion
+}  // namespace dentra
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+
+// Max number of samples of sliding median of auto mode sensors, the actual one is set at runtime.
+#ifndef TION_AUTO_MEDIAN_WINDOW
+#define TION_AUTO_MEDIAN_WINDOW 5
+#endif
+
+namespace dentra {
+namespace tion {
+namespace auto_co2 {
+
+/// Sensors of auto mode.
+enum AutoSensor : uint8_t {
+  AUTO_SENSOR_CO2,
+  AUTO_SENSOR_PM25,
+  AUTO_SENSOR_VOC,
+  AUTO_SENSOR_HUMIDITY,
+  AUTO_SENSOR_COUNT,
+};
+
+/// Sliding median of the last window samples followed by EWMA. Fixed memory, O(window) per sample.
+template<size_t max_window> class AutoInputFilter {
+  static_assert(max_window > 0 && max_window < 256, "Invalid max_window");
+
+ public:
+  /// @param alpha EWMA smoothing factor in (0, 1], 1 disables smoothing.
+  void set_alpha(float alpha) { this->alpha_ = alpha; }
+  /// Sets number of samples of the median limited to max_window. Resets the filter.
+  void set_window(size_t window) {
+    this->window_ = window == 0 ? 1 : window > max_window ? max_window : window;
+    this->reset();
+  }
+  size_t get_window() const { return this->window_; }
+
+  /// Adds the sample and returns filtered value.
+  float update(float value) {
+    if (this->size_ == this->window_) {
+      this->remove_sorted_(this->samples_[this->pos_]);
+    } else {
+      this->size_++;
+    }
+    this->samples_[this->pos_] = value;
+    this->pos_ = this->pos_ + 1 == this->window_ ? 0 : this->pos_ + 1;
+    this->insert_sorted_(value);
+
+    const float median = this->sorted_[(this->size_ - 1) / 2];
+    this->value_ = std::isnan(this->value_) ? median : this->value_ + this->alpha_ * (median - this->value_);
+    return this->value_;
+  }
+
+  /// Returns filtered value or NaN if there are no samples.
+  float value() const { return this->value_; }
+  size_t size() const { return this->size_; }
+
+  void reset() {
+    this->size_ = 0;
+    this->pos_ = 0;
+    this->value_ = NAN;
+  }
+
+ protected:
+  // samples in order of arrival
+  float samples_[max_window]{};
+  // the same samples sorted ascending
+  float sorted_[max_window]{};
+  uint8_t window_{max_window};
+  uint8_t size_{};
+  uint8_t pos_{};
+  float alpha_{1.0f};
+  float value_{NAN};
+
+  void remove_sorted_(float value) {
+    size_t i = 0;
+    while (i < this->size_ - 1u && this->sorted_[i] != value) {
+      i++;
+    }
+    for (; i < this->size_ - 1u; i++) {
+      this->sorted_[i] = this->sorted_[i + 1];
+    }
+  }
+
+  // size_ already includes the value
+  void insert_sorted_(float value) {
+    size_t i = this->size_ - 1u;
+    for (; i > 0 && this->sorted_[i - 1] > value; i--) {
+      this->sorted_[i] = this->sorted_[i - 1];
+    }
+    this->sorted_[i] = value;
+  }
+};
+
+/// Input of auto mode. Filters samples of each sensor, drops stale sensors and fuses the rest into
+/// the single CO2 equivalent demand as max of demands of each sensor.
+class AutoInputPipeline {
+ public:
+  using filter_type = AutoInputFilter<TION_AUTO_MEDIAN_WINDOW>;
+
+  /// Enables sensor. Its demand is proportional to the value relative to the setpoint, so the value
+  /// equal to the setpoint demands the same airflow as CO2 at CO2 setpoint.
+  /// @param setpoint target value of the sensor, 0 disables the sensor. Ignored for CO2.
+  void set_sensor(AutoSensor sensor, float setpoint);
+  /// @param alpha EWMA smoothing factor in (0, 1] of all sensors, 1 disables smoothing.
+  void set_smoothing(float alpha);
+  /// @param window number of samples of the median of all sensors, up to TION_AUTO_MEDIAN_WINDOW.
+  void set_median_window(uint8_t window);
+  /// @param timeout time after the last sample to treat the sensor as stale [ms], 0 disables it.
+  void set_timeout(uint32_t timeout) { this->timeout_ = timeout; }
+
+  /// Adds the sample of the sensor. NaN is ignored.
+  void update(AutoSensor sensor, float value);
+
+  /// Returns max CO2 equivalent demand of not stale sensors [ppm] or 0 if there is no data.
+  uint16_t demand(uint16_t co2_setpoint) const;
+
+  /// Returns filtered value of the sensor or NaN if it has no data or stale.
+  float get_value(AutoSensor sensor) const;
+  bool is_stale(AutoSensor sensor) const;
+
+ protected:
+  struct {
+    filter_type filter;
+    // setpoint of the sensor, 0 if disabled
+    float setpoint;
+    uint32_t last_update;
+  } sensors_[AUTO_SENSOR_COUNT]{};
+  uint32_t timeout_{};
+};
+
+}  // namespace auto_co2
+}  // namespace tion
+}  // namespace dentra
@@ -0,0 +1,74 @@
+#include <cinttypes>
+
+#include "log.h"
+#include "utils.h"
+#include "auto_output.h"
+
+namespace dentra {
+namespace tion {
+namespace auto_co2 {
+
+static const char *const TAG = "tion-api-auto";
+
+void AutoOutputStage::set_rate_limit(uint8_t burst, uint32_t interval) {
+  this->burst_ = burst;
+  this->interval_ = interval;
+  this->tokens_ = burst;
+  this->last_refill_ = tion::millis();
+}
+
+uint8_t AutoOutputStage::hold(int rate, uint8_t speed, uint8_t current, const uint8_t *prod) {
+  if (this->hysteresis_ == 0 || current == 0 || speed == current) {
+    return speed;
+  }
+  // speed is selected for rate in (prod[speed - 1], prod[speed]]
+  const int band = (prod[current] - prod[current - 1]) * this->hysteresis_ / 100;
+  const bool inside = speed > current ? rate <= prod[current] + band : rate > prod[current - 1] - band;
+  if (inside) {
+    TION_LOGV(TAG, "Hold speed %u, rate %d", current, rate);
+    this->stats_.hysteresis++;
+    return current;
+  }
+  return speed;
+}
+
+bool AutoOutputStage::allow() {
+  const uint32_t now = tion::millis();
+
+  if (this->min_dwell_ > 0 && this->last_change_ != 0 && now - this->last_change_ < this->min_dwell_) {
+    TION_LOGV(TAG, "Dwell %" PRIu32 " ms", now - this->last_change_);
+    this->stats_.dwell++;
+    return false;
+  }
+
+  if (this->burst_ > 0) {
+    this->refill_(now);
+    if (this->tokens_ == 0) {
+      TION_LOGV(TAG, "Rate limited");
+      this->stats_.rate_limit++;
+      return false;
+    }
+    this->tokens_--;
+  }
+
+  this->last_change_ = now;
+  return true;
+}
+
+void AutoOutputStage::refill_(uint32_t now) {
+  if (this->tokens_ >= this->burst_ || this->interval_ == 0) {
+    this->tokens_ = this->burst_;
+    this->last_refill_ = now;
+    return;
+  }
+  const uint32_t earned = (now - this->last_refill_) / this->interval_;
+  if (earned == 0) {
+    return;
+  }
+  this->tokens_ = earned >= static_cast<uint32_t>(this->burst_ - this->tokens_) ? this->burst_ : this->tokens_ + earned;
+  this->last_refill_ += earned * this->interval_;
+}
+
+}  // namespace auto_co2
+}  // namespace tion
+}  // namespace dentra
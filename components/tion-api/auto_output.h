@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dentra {
+namespace tion {
+namespace auto_co2 {
+
+/// Output stage of auto mode. Limits fan speed changes, so the breezer is not rewritten on each CO2 sample
+/// when airflow rate is near the boundary of the speed.
+class AutoOutputStage {
+ public:
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  struct stats_t {
+    // Number of changes kept inside hysteresis band of the current speed.
+    uint32_t hysteresis;
+    // Number of changes suppressed due to min dwell time.
+    uint32_t dwell;
+    // Number of changes suppressed due to write rate limit.
+    uint32_t rate_limit;
+  };
+
+  /// @param hysteresis hysteresis band in percent of the current speed airflow range, 0 disables it.
+  void set_hysteresis(uint8_t hysteresis) { this->hysteresis_ = hysteresis; }
+  /// @param min_dwell min time to keep the speed [ms], 0 disables it.
+  void set_min_dwell(uint32_t min_dwell) { this->min_dwell_ = min_dwell; }
+  /// Token bucket of fan speed changes.
+  /// @param burst max number of changes in a row, 0 disables the limit.
+  /// @param interval time to earn one more change [ms].
+  void set_rate_limit(uint8_t burst, uint32_t interval);
+
+  uint8_t get_hysteresis() const { return this->hysteresis_; }
+  uint32_t get_min_dwell() const { return this->min_dwell_; }
+  uint8_t get_rate_limit_burst() const { return this->burst_; }
+  uint32_t get_rate_limit_interval() const { return this->interval_; }
+  const stats_t &get_stats() const { return this->stats_; }
+
+  /// Returns current speed while airflow rate stays inside hysteresis band of it, otherwise the new speed.
+  /// @param rate airflow rate [m³/h]
+  /// @param speed new speed selected for the rate
+  /// @param current current speed
+  /// @param prod airflow rate of each speed, speed is selected when rate > prod[speed - 1]
+  uint8_t hold(int rate, uint8_t speed, uint8_t current, const uint8_t *prod);
+
+  /// Returns true if the speed may be changed now. Call only when the change will be written.
+  bool allow();
+
+ protected:
+  uint8_t hysteresis_{};
+  uint8_t burst_{};
+  uint8_t tokens_{};
+  uint32_t min_dwell_{};
+  uint32_t interval_{};
+  uint32_t last_change_{};
+  uint32_t last_refill_{};
+  stats_t stats_{};
+
+  void refill_(uint32_t now);
+};
+
+}  // namespace auto_co2
+}  // namespace tion
+}  // namespace dentra
@@ -3,6 +3,16 @@
 #include <cstdint>
 #include <cstddef>
 
+// Number of bytes processed per table lookup round by crc16_ccitt_false: 1, 4 or 8.
+// ESP8266 uses the classic byte-wise table stored in PROGMEM.
+#ifndef TION_CRC16_SLICE
+#if defined(ESP8266)
+#define TION_CRC16_SLICE 1
+#else
+#define TION_CRC16_SLICE 4
+#endif
+#endif
+
 namespace dentra {
 namespace tion {
 
@@ -12,5 +22,42 @@ uint16_t crc16_ccitt_false(uint16_t init, const void *data, size_t size);
 /// CRC-16/CCITT-FALSE with 0xFFFF initial value. The result is in big-endian byte order.
 inline uint16_t crc16_ccitt_false_ffff(const void *data, size_t size) { return crc16_ccitt_false(0xFFFF, data, size); }
 
+// Particular CRC-16/CCITT-FALSE implementations, crc16_ccitt_false is one of them selected by TION_CRC16_SLICE.
+// Unused implementations with their tables are removed by the linker.
+
+/// Half-byte implementation with 16 entries table.
+uint16_t crc16_ccitt_false_nibble(uint16_t init, const void *data, size_t size);
+/// Byte-wise implementation with 256 entries table.
+uint16_t crc16_ccitt_false_slice1(uint16_t init, const void *data, size_t size);
+/// Slicing-by-4 implementation with 4x256 entries table.
+uint16_t crc16_ccitt_false_slice4(uint16_t init, const void *data, size_t size);
+/// Slicing-by-8 implementation with 8x256 entries table.
+uint16_t crc16_ccitt_false_slice8(uint16_t init, const void *data, size_t size);
+
+/// Table footprint in bytes of each implementation.
+enum : size_t {
+  CRC16_CCITT_FALSE_NIBBLE_TABLE_SIZE = 16 * sizeof(uint16_t),
+  CRC16_CCITT_FALSE_SLICE1_TABLE_SIZE = 1 * 256 * sizeof(uint16_t),
+  CRC16_CCITT_FALSE_SLICE4_TABLE_SIZE = 4 * 256 * sizeof(uint16_t),
+  CRC16_CCITT_FALSE_SLICE8_TABLE_SIZE = 8 * 256 * sizeof(uint16_t),
+};
+
+/// Incremental CRC-16/CCITT-FALSE calculation, e.g. for frames received in several packets.
+class Crc16Ccitt {
+ public:
+  explicit Crc16Ccitt(uint16_t init = 0xFFFF) : crc_(init) {}
+
+  void reset(uint16_t init = 0xFFFF) { this->crc_ = init; }
+  Crc16Ccitt &update(const void *data, size_t size) {
+    this->crc_ = crc16_ccitt_false(this->crc_, data, size);
+    return *this;
+  }
+  /// CRC of all data passed to update since reset. The result is in big-endian byte order.
+  uint16_t value() const { return this->crc_; }
+
+ protected:
+  uint16_t crc_;
+};
+
 }  // namespace tion
 }  // namespace dentra
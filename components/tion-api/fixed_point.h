@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+
+namespace dentra {
+namespace tion {
+
+/// Signed 32-bit fixed point number with frac_bits fractional bits and saturating arithmetic.
+/// Used instead of float on targets without FPU.
+template<int frac_bits> class FixedPoint {
+  static_assert(frac_bits > 0 && frac_bits < 31, "Invalid frac_bits");
+
+ public:
+  constexpr static int32_t ONE = int32_t(1) << frac_bits;
+
+  constexpr FixedPoint() = default;
+  constexpr FixedPoint(int value) : raw_(saturate_(static_cast<int64_t>(value) * ONE)) {}
+  /// NaN is converted to zero.
+  explicit FixedPoint(float value)
+      : raw_(std::isnan(value) ? 0 : saturate_(static_cast<int64_t>(std::lround(double(value) * ONE)))) {}
+
+  constexpr static FixedPoint from_raw(int32_t raw) {
+    FixedPoint res;
+    res.raw_ = raw;
+    return res;
+  }
+  /// Returns num / den without intermediate rounding.
+  constexpr static FixedPoint from_ratio(int64_t num, int64_t den) { return from_raw(saturate_(num * ONE / den)); }
+  constexpr static FixedPoint lowest() { return from_raw(INT32_MIN); }
+  constexpr static FixedPoint highest() { return from_raw(INT32_MAX); }
+
+  constexpr int32_t raw() const { return this->raw_; }
+  /// Truncates toward zero like float to int conversion.
+  constexpr explicit operator int() const { return this->raw_ / ONE; }
+  constexpr explicit operator float() const { return static_cast<float>(this->raw_) / ONE; }
+
+  constexpr FixedPoint operator-() const { return from_raw(saturate_(-static_cast<int64_t>(this->raw_))); }
+  constexpr FixedPoint operator+(FixedPoint other) const {
+    return from_raw(saturate_(static_cast<int64_t>(this->raw_) + other.raw_));
+  }
+  constexpr FixedPoint operator-(FixedPoint other) const {
+    return from_raw(saturate_(static_cast<int64_t>(this->raw_) - other.raw_));
+  }
+  constexpr FixedPoint operator*(FixedPoint other) const {
+    return from_raw(saturate_((static_cast<int64_t>(this->raw_) * other.raw_) >> frac_bits));
+  }
+
+  constexpr bool operator<(FixedPoint other) const { return this->raw_ < other.raw_; }
+  constexpr bool operator>(FixedPoint other) const { return this->raw_ > other.raw_; }
+  constexpr bool operator==(FixedPoint other) const { return this->raw_ == other.raw_; }
+  constexpr bool operator!=(FixedPoint other) const { return this->raw_ != other.raw_; }
+
+ protected:
+  int32_t raw_{};
+
+  constexpr static int32_t saturate_(int64_t value) {
+    return value > INT32_MAX ? INT32_MAX : value < INT32_MIN ? INT32_MIN : static_cast<int32_t>(value);
+  }
+};
+
+}  // namespace tion
+}  // namespace dentra
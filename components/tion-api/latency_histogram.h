@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dentra {
+namespace tion {
+
+/// Fixed memory histogram of latencies [ms] with power of two buckets:
+/// [0, base), [base, base * 2), [base * 2, base * 4), ..., [base << (buckets - 2), inf).
+template<uint32_t base_value, size_t bucket_count> class LatencyHistogram {
+  static_assert(base_value > 0, "Invalid base_value");
+  static_assert(bucket_count > 1 && bucket_count < 24, "Invalid bucket_count");
+
+ public:
+  constexpr static size_t size() { return bucket_count; }
+  /// Returns exclusive upper bound of the bucket [ms], UINT32_MAX for the last one.
+  constexpr static uint32_t upper_bound(size_t bucket) {
+    return bucket + 1 < bucket_count ? base_value << bucket : UINT32_MAX;
+  }
+
+  void add(uint32_t latency) {
+    size_t bucket = 0;
+    while (bucket + 1 < bucket_count && latency >= upper_bound(bucket)) {
+      bucket++;
+    }
+    this->buckets_[bucket]++;
+    this->count_++;
+    this->sum_ += latency;
+    if (latency > this->max_) {
+      this->max_ = latency;
+    }
+  }
+
+  uint32_t operator[](size_t bucket) const { return this->buckets_[bucket]; }
+  uint32_t count() const { return this->count_; }
+  uint32_t max() const { return this->max_; }
+  uint32_t mean() const { return this->count_ ? this->sum_ / this->count_ : 0; }
+
+  /// Returns upper bound of the bucket containing the percentile [ms] or 0 if there is no data.
+  uint32_t percentile(uint8_t percent) const {
+    if (this->count_ == 0) {
+      return 0;
+    }
+    const uint64_t rank = (static_cast<uint64_t>(this->count_) * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucket_count; i++) {
+      seen += this->buckets_[i];
+      if (seen >= rank && seen > 0) {
+        return upper_bound(i);
+      }
+    }
+    return UINT32_MAX;
+  }
+
+  void reset() { *this = {}; }
+
+ protected:
+  uint32_t buckets_[bucket_count]{};
+  uint32_t count_{};
+  uint32_t max_{};
+  uint64_t sum_{};
+};
+
+}  // namespace tion
+}  // namespace dentra
@@ -4,34 +4,59 @@
 #include <cmath>
 
 #include "utils.h"
+#include "fixed_point.h"
 
 namespace dentra {
 namespace tion {
 namespace auto_co2 {
 
+/// Math of PIController value type.
+template<typename value_type> struct PIValue;
+
+template<> struct PIValue<float> {
+  static float from(float value) { return value; }
+  static float lowest() { return -INFINITY; }
+  static float highest() { return INFINITY; }
+  static float minutes(uint32_t ms) { return ms * 0.001f / 60.0f; }
+};
+
+template<int frac_bits> struct PIValue<FixedPoint<frac_bits>> {
+  using value_type = FixedPoint<frac_bits>;
+  static value_type from(float value) { return value_type(value); }
+  static value_type lowest() { return value_type::lowest(); }
+  static value_type highest() { return value_type::highest(); }
+  static value_type minutes(uint32_t ms) { return value_type::from_ratio(ms, 60 * 1000); }
+};
+
 /// @brief PI Controller.
 /// @link https://www.sciencedirect.com/science/article/pii/S0378778823009477
-class PIController {
+/// @tparam value_type float or FixedPoint for targets without FPU.
+template<typename value_type> class BasicPIController {
+  using math = PIValue<value_type>;
+
  public:
   /// @param kp proportional gain [L/s.ppm-CO2]
   /// @param ti integral gain [min]
   /// @param db dead band [ppm]
   /// @param v_oa_min minimum outdoor airflow rate [L/s]
   /// @param v_oa_max maximum outdoor airflow rate [L/s]
-  PIController(float kp, float ti, int db = 0, float min = NAN, float max = NAN)
-      : kp_(kp), ti_(ti), db_(db), v_oa_min_(min), v_oa_max_(max) {}
+  BasicPIController(float kp, float ti, int db = 0, float min = NAN, float max = NAN) {
+    this->reset(kp, ti, db, min, max);
+  }
 
   /// @param setpoint CO2 setpoint [ppm]
   /// @param current CO2 concentration [ppm]
   /// @return outdoor airflow rate [L/s]
-  float update(int setpoint, int current);
+  value_type update(int setpoint, int current);
 
-  void set_min(float min) { this->v_oa_min_ = min; }
-  void set_max(float max) { this->v_oa_max_ = max; }
+  /// NaN means no limit.
+  void set_min(float min) { this->v_oa_min_ = std::isnan(min) ? math::lowest() : math::from(min); }
+  /// NaN means no limit.
+  void set_max(float max) { this->v_oa_max_ = std::isnan(max) ? math::highest() : math::from(max); }
 
   /// @brief Resets integral error.
   void reset() {
-    this->ib_ = 0;
+    this->ib_ = {};
     this->last_time_ = 0;
   }
   /// @brief Resets Kp, Ti, db without touching min and max
@@ -40,17 +65,21 @@ class PIController {
 
  protected:
   /// proportional gain [L/s.ppm-CO2]
-  float kp_;
+  value_type kp_{};
   /// integral gain [min]
-  float ti_;
+  value_type ti_{};
+  /// 1 / kp_, so update does not divide.
+  value_type kp_inv_{};
+  /// 1 / ti_, so update does not divide.
+  value_type ti_inv_{};
   /// dead band [ppm]
-  int db_;
+  int db_{};
   /// minimum outdoor airflow rate [L/s]
-  float v_oa_min_;
+  value_type v_oa_min_{};
   /// maximum outdoor airflow rate [L/s]
-  float v_oa_max_;
+  value_type v_oa_max_{};
   /// integral error with anti-integral windup [min.ppm-CO2].
-  float ib_{};
+  value_type ib_{};
   /// last time used in dt_() calculation.
   uint32_t last_time_{};
 
@@ -61,10 +90,21 @@ class PIController {
     this->last_time_ = now;
     return res;
   }
-  /// time step [s].
-  float dt_s_() { return this->dt_ms_() * 0.001f; }
 };
 
+// Q19.12: integral error exceeds Q16.16 range with typical Ti and CO2 errors.
+using PIFixed = FixedPoint<12>;
+
+using PIController = BasicPIController<float>;
+using FixedPIController = BasicPIController<PIFixed>;
+
+// Controller used by auto mode.
+#ifdef TION_AUTO_PI_FIXED
+using AutoPIController = FixedPIController;
+#else
+using AutoPIController = PIController;
+#endif
+
 }  // namespace auto_co2
 }  // namespace tion
 }  // namespace dentra
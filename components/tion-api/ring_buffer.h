@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace dentra {
+namespace tion {
+
+/// Returns the smallest power of two not less than size.
+constexpr size_t ring_buffer_capacity(size_t size) {
+  size_t capacity = 1;
+  while (capacity < size) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+/// Fixed size byte ring buffer. Capacity must be a power of two.
+/// Indexes are free-running, so the buffer is full when size() == capacity().
+template<size_t capacity_value> class RingBuffer {
+  static_assert(capacity_value > 0 && (capacity_value & (capacity_value - 1)) == 0,
+                "capacity_value must be a power of two");
+  static_assert(capacity_value <= 0x8000, "capacity_value is too large");
+
+ public:
+  constexpr static size_t capacity() { return capacity_value; }
+
+  size_t size() const { return static_cast<uint16_t>(this->tail_ - this->head_); }
+  size_t free() const { return capacity_value - this->size(); }
+  bool empty() const { return this->head_ == this->tail_; }
+  void clear() { this->head_ = this->tail_ = 0; }
+
+  /// Returns byte at pos from the head. No bounds check.
+  uint8_t operator[](size_t pos) const { return this->buf_[(this->head_ + pos) & MASK]; }
+
+  /// Drops up to size bytes from the head.
+  void skip(size_t size) { this->head_ += size < this->size() ? size : this->size(); }
+
+  /// Returns pointer to contiguous free space at the tail and its size.
+  uint8_t *write_ptr(size_t *size) {
+    const size_t pos = this->tail_ & MASK;
+    const size_t till_end = capacity_value - pos;
+    const size_t free = this->free();
+    *size = free < till_end ? free : till_end;
+    return &this->buf_[pos];
+  }
+  /// Commits size bytes written to write_ptr().
+  void commit(size_t size) { this->tail_ += size; }
+
+  /// Returns pointer to contiguous data starting at pos from the head and its size.
+  const uint8_t *read_ptr(size_t pos, size_t *size) const {
+    const size_t idx = (this->head_ + pos) & MASK;
+    const size_t till_end = capacity_value - idx;
+    const size_t avail = this->size() - pos;
+    *size = avail < till_end ? avail : till_end;
+    return &this->buf_[idx];
+  }
+
+  /// Finds byte starting from pos. Returns size() if not found.
+  size_t find(uint8_t byte, size_t pos = 0) const {
+    const size_t size = this->size();
+    while (pos < size) {
+      size_t len;
+      const auto *ptr = this->read_ptr(pos, &len);
+      // memchr is word-at-a-time on both newlib and glibc.
+      const auto *found = static_cast<const uint8_t *>(std::memchr(ptr, byte, len));
+      if (found != nullptr) {
+        return pos + (found - ptr);
+      }
+      pos += len;
+    }
+    return size;
+  }
+
+  /// Returns pointer to size contiguous bytes starting at the head.
+  /// When data wraps around it is copied to buf, which must have at least size bytes.
+  const uint8_t *linearize(size_t size, uint8_t *buf) const {
+    size_t len;
+    const auto *ptr = this->read_ptr(0, &len);
+    if (len >= size) {
+      return ptr;
+    }
+    std::memcpy(buf, ptr, len);
+    std::memcpy(buf + len, this->buf_, size - len);
+    return buf;
+  }
+
+ protected:
+  enum : size_t { MASK = capacity_value - 1 };
+  uint8_t buf_[capacity_value];
+  uint16_t head_{};
+  uint16_t tail_{};
+};
+
+}  // namespace tion
+}  // namespace dentra
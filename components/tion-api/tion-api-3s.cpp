@@ -11,6 +11,7 @@ namespace dentra {
 namespace tion_3s {
 
 using tion::TionTraits;
+using tion::TionFrameBuilder;
 
 #define ERRORS_COUNT 17
 
@@ -78,6 +79,33 @@ struct Tion3sTimersResponse {
 
 uint16_t Tion3sApi::get_state_type() const { return FRAME_TYPE_RSP(FRAME_TYPE_STATE_GET); }
 
+tion::TionTxPolicy Tion3sApi::get_tx_policy(uint16_t type, const void *data, size_t size) {
+  if (type == FRAME_TYPE_REQ(FRAME_TYPE_STATE_SET)) {
+    // only the newest state is sent, but resets must not be overwritten
+    const auto *st_set = static_cast<const tion3s_state_set_t *>(data);
+    if (size >= sizeof(*st_set) && !st_set->filter_time.reset && !st_set->factory_reset) {
+      return tion::TX_POLICY_LATEST;
+    }
+  }
+  return tion::TX_POLICY_FIFO;
+}
+
+tion::tion_request_info_t Tion3sApi::get_request_info(uint16_t type, const void * /*data*/, size_t /*size*/) {
+  if (type == FRAME_TYPE_REQ(FRAME_TYPE_STATE_GET)) {
+    return {.rsp_type = FRAME_TYPE_RSP(FRAME_TYPE_STATE_GET), .request_id = 0, .idempotent = true};
+  }
+  if (type == FRAME_TYPE_REQ(FRAME_TYPE_STATE_SET)) {
+    return {.rsp_type = FRAME_TYPE_RSP(FRAME_TYPE_STATE_SET), .request_id = 0, .idempotent = false};
+  }
+  if (type == FRAME_TYPE_REQ(FRAME_TYPE_TIMERS_GET)) {
+    return {.rsp_type = FRAME_TYPE_RSP(FRAME_TYPE_TIMERS_GET), .request_id = 0, .idempotent = true};
+  }
+  if (type == FRAME_TYPE_REQ(FRAME_TYPE_SRV_MODE_SET)) {
+    return {.rsp_type = FRAME_TYPE_RSP(FRAME_TYPE_SRV_MODE_SET), .request_id = 0, .idempotent = false};
+  }
+  return {};
+}
+
 void Tion3sApi::read_frame(uint16_t frame_type, const void *frame_data, size_t frame_data_size) {
   // invalid size is never possible
   // if (frame_data_size != sizeof(tion3s_state_t)) {
@@ -139,22 +167,22 @@ bool Tion3sApi::write_state_(const tion::TionState &state) const {
     TION_LOGW(TAG, "State was not initialized");
     return false;
   }
-  tion3s_state_set_t st_set(state);
-  TION_DUMP(TAG, "fan   : %u", st_set.fan_speed);
-  TION_DUMP(TAG, "temp  : %u", st_set.target_temperature);
+  TionFrameBuilder<tion3s_state_set_t> st_set(*this, state);
+  TION_DUMP(TAG, "fan   : %u", st_set->fan_speed);
+  TION_DUMP(TAG, "temp  : %u", st_set->target_temperature);
   TION_DUMP(TAG, "gate  : %s",
-            st_set.gate_position == tion3s_state_t::GATE_POSITION_INDOOR    ? "indoor"
-            : st_set.gate_position == tion3s_state_t::GATE_POSITION_OUTDOOR ? "outdoor"
-            : st_set.gate_position == tion3s_state_t::GATE_POSITION_MIXED   ? "mixed"
-                                                                            : "unknown");
-  TION_DUMP(TAG, "heat  : %s", ONOFF(st_set.flags.heater_state));
-  TION_DUMP(TAG, "power : %s", ONOFF(st_set.flags.power_state));
-  TION_DUMP(TAG, "sound : %s", ONOFF(st_set.flags.sound_state));
-  TION_DUMP(TAG, "auto  : %s", ONOFF(st_set.flags.ma_auto));
-  TION_DUMP(TAG, "ma    : %s", ONOFF(st_set.flags.ma_connected));
-  TION_DUMP(TAG, "preset: %s", ONOFF(st_set.flags.preset_state));
-
-  return this->write_frame(FRAME_TYPE_REQ(FRAME_TYPE_STATE_SET), st_set);
+            st_set->gate_position == tion3s_state_t::GATE_POSITION_INDOOR    ? "indoor"
+            : st_set->gate_position == tion3s_state_t::GATE_POSITION_OUTDOOR ? "outdoor"
+            : st_set->gate_position == tion3s_state_t::GATE_POSITION_MIXED   ? "mixed"
+                                                                             : "unknown");
+  TION_DUMP(TAG, "heat  : %s", ONOFF(st_set->flags.heater_state));
+  TION_DUMP(TAG, "power : %s", ONOFF(st_set->flags.power_state));
+  TION_DUMP(TAG, "sound : %s", ONOFF(st_set->flags.sound_state));
+  TION_DUMP(TAG, "auto  : %s", ONOFF(st_set->flags.ma_auto));
+  TION_DUMP(TAG, "ma    : %s", ONOFF(st_set->flags.ma_connected));
+  TION_DUMP(TAG, "preset: %s", ONOFF(st_set->flags.preset_state));
+
+  return st_set.write(FRAME_TYPE_REQ(FRAME_TYPE_STATE_SET));
 }
 
 bool Tion3sApi::reset_filter_(const tion::TionState &state) const {
@@ -178,9 +206,9 @@ bool Tion3sApi::reset_filter_(const tion::TionState &state) const {
   // 3D:01:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:5A
   // 3D:04:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:5A
 
-  tion3s_state_set_t st_set(state);
-  st_set.filter_time.reset = true;
-  return this->write_frame(FRAME_TYPE_REQ(FRAME_TYPE_STATE_SET), st_set);
+  TionFrameBuilder<tion3s_state_set_t> st_set(*this, state);
+  st_set->filter_time.reset = true;
+  return st_set.write(FRAME_TYPE_REQ(FRAME_TYPE_STATE_SET));
 }
 
 bool Tion3sApi::request_command4() const {
@@ -194,9 +222,9 @@ bool Tion3sApi::factory_reset_(const tion::TionState &state) const {
     TION_LOGW(TAG, "State was not initialized");
     return false;
   }
-  tion3s_state_set_t st_set(state);
-  st_set.factory_reset = true;
-  return this->write_frame(FRAME_TYPE_REQ(FRAME_TYPE_STATE_SET), st_set);
+  TionFrameBuilder<tion3s_state_set_t> st_set(*this, state);
+  st_set->factory_reset = true;
+  return st_set.write(FRAME_TYPE_REQ(FRAME_TYPE_STATE_SET));
 }
 
 Tion3sApi::Tion3sApi() {
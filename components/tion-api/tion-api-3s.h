@@ -3,6 +3,8 @@
 #include <functional>
 
 #include "tion-api-writer.h"
+#include "tion-api-tx-queue.h"
+#include "tion-api-request-tracker.h"
 #include "tion-api-3s-internal.h"
 
 namespace dentra {
@@ -10,23 +12,37 @@ namespace tion {
 
 class Tion3sApi : public TionApiBase, public tion::TionApiWriter {
  public:
+  /// Features known at compile time.
+  using static_traits_type = Tion3sStaticTraits;
+
   Tion3sApi();
 
   void read_frame(uint16_t frame_type, const void *frame_data, size_t frame_data_size);
 
   uint16_t get_state_type() const;
 
+  /// Returns TX queue policy of the frame.
+  static tion::TionTxPolicy get_tx_policy(uint16_t type, const void *data, size_t size);
+  /// Returns response type of the request frame.
+  static tion::tion_request_info_t get_request_info(uint16_t type, const void *data, size_t size);
+
   bool pair() const;
 
   bool request_command4() const;
 
   void request_state() override { this->request_state_(); }
-  void write_state(tion::TionStateCall *call) override { this->write_state_(this->make_write_state_(call)); }
+  void write_state(tion::TionStateCall *call) override {
+    const auto state = this->make_write_state_(call);
+    if (!this->write_suppressed_(state) && this->write_state_(state)) {
+      this->state_written_(state, 0);
+    }
+  }
   void reset_filter() override { this->reset_filter_(this->state_); }
 
  protected:
   bool request_state_() const;
   bool write_state_(const tion::TionState &state) const;
+  bool write_retry_(const tion::TionState &state, uint32_t request_id) override { return this->write_state_(state); }
   bool reset_filter_(const tion::TionState &state) const;
   bool factory_reset_(const tion::TionState &state) const;
 
@@ -1,4 +1,5 @@
 #include <cstddef>
+#include <cstring>
 #include <cmath>
 #include <cinttypes>
 
@@ -18,10 +19,62 @@ using tion::tion_dev_info_t;
 using tion::TionGatePosition;
 using tion::TionTraits;
 using tion::TionState;
+using tion::TionFrameBuilder;
 
 uint16_t Tion4sApi::get_state_type() const { return FRAME_TYPE_STATE_RSP; }
 
+tion::TionTxPolicy Tion4sApi::get_tx_policy(uint16_t type, const void *data, size_t size) {
+  if (type == FRAME_TYPE_STATE_SET) {
+    // only the newest state is sent, but resets must not be overwritten
+    const auto *req = static_cast<const tion4s_raw_state_set_req_t *>(data);
+    if (size == sizeof(*req) && !req->data.factory_reset && !req->data.error_reset && !req->data.filter_reset) {
+      return tion::TX_POLICY_LATEST;
+    }
+    return tion::TX_POLICY_FIFO;
+  }
+  if (type == FRAME_TYPE_HEARTBIT_REQ || type == FRAME_TYPE_TURBO_SET) {
+    return tion::TX_POLICY_PRIORITY;
+  }
+  if (type == FRAME_TYPE_TIMER_REQ || type == FRAME_TYPE_TIMER_SET) {
+    // all timers are requested at once and do not fit the queue
+    return tion::TX_POLICY_BYPASS;
+  }
+  return tion::TX_POLICY_FIFO;
+}
+
+// 0xXX32 - request, 0xXX30 - set, 0xXX31 - response to both of them.
+enum : uint8_t { FRAME_CLASS_SET = 0x30, FRAME_CLASS_RSP = 0x31, FRAME_CLASS_REQ = 0x32 };
+
+tion::tion_request_info_t Tion4sApi::get_request_info(uint16_t type, const void *data, size_t size) {
+  const uint8_t frame_class = type & 0xFF;
+  if ((frame_class != FRAME_CLASS_REQ && frame_class != FRAME_CLASS_SET) || type == FRAME_TYPE_STATE_SAV) {
+    return {};
+  }
+  uint32_t request_id = 0;
+  if (size >= sizeof(request_id)) {
+    std::memcpy(&request_id, data, sizeof(request_id));
+  }
+  return {
+      .rsp_type = static_cast<uint16_t>((type & 0xFF00) | FRAME_CLASS_RSP),
+      .request_id = request_id,
+      .idempotent = frame_class == FRAME_CLASS_REQ,
+  };
+}
+
+uint32_t Tion4sApi::get_response_id(uint16_t type, const void *data, size_t size) {
+  // dev info and heartbeat responses do not carry request id
+  if (type == FRAME_TYPE_DEV_INFO_RSP || type == FRAME_TYPE_HEARTBIT_RSP || type == FRAME_TYPE_TEST_RSP) {
+    return 0;
+  }
+  uint32_t request_id = 0;
+  if (size >= sizeof(request_id)) {
+    std::memcpy(&request_id, data, sizeof(request_id));
+  }
+  return request_id;
+}
+
 void Tion4sApi::read_frame(uint16_t frame_type, const void *frame_data, size_t frame_data_size) {
+  this->poll_.on_frame(frame_type);
   // do not use switch statement with non-contiguous values, as this will generate a lookup table with wasted space.
 #ifdef TION_ENABLE_HEARTBEAT
   if (frame_type == FRAME_TYPE_HEARTBIT_RSP) {
@@ -181,19 +234,19 @@ bool Tion4sApi::write_state(const TionState &state, uint32_t request_id) const {
     TION_LOGW(TAG, "State was not initialized");
     return false;
   }
-  tion4s_raw_state_set_req_t req(request_id, state);
-  TION_DUMP(TAG, "req  : %" PRIu32, req.request_id);
-  TION_DUMP(TAG, "power: %s", ONOFF(req.data.power_state));
-  TION_DUMP(TAG, "sound: %s", ONOFF(req.data.sound_state));
-  TION_DUMP(TAG, "led  : %s", ONOFF(req.data.led_state));
-  TION_DUMP(TAG, "heat : %s", ONOFF(req.data.heater_mode != tion4s_state_t::HEATER_MODE_FANONLY));
-  TION_DUMP(TAG, "comm : %s", req.data.comm_source == tion::CommSource::AUTO ? "AUTO" : "USER");
-  TION_DUMP(TAG, "auto : %s", ONOFF(req.data.ma_connected));
+  TionFrameBuilder<tion4s_raw_state_set_req_t> req(*this, request_id, state);
+  TION_DUMP(TAG, "req  : %" PRIu32, req->request_id);
+  TION_DUMP(TAG, "power: %s", ONOFF(req->data.power_state));
+  TION_DUMP(TAG, "sound: %s", ONOFF(req->data.sound_state));
+  TION_DUMP(TAG, "led  : %s", ONOFF(req->data.led_state));
+  TION_DUMP(TAG, "heat : %s", ONOFF(req->data.heater_mode != tion4s_state_t::HEATER_MODE_FANONLY));
+  TION_DUMP(TAG, "comm : %s", req->data.comm_source == tion::CommSource::AUTO ? "AUTO" : "USER");
+  TION_DUMP(TAG, "auto : %s", ONOFF(req->data.ma_connected));
   TION_DUMP(TAG, "gate : %s",
-            req.data.gate_position == tion4s_state_t::GATE_POSITION_OUTDOOR ? "inflow" : "recirculation");
-  TION_DUMP(TAG, "temp : %u", req.data.target_temperature);
-  TION_DUMP(TAG, "fan  : %u", req.data.fan_speed);
-  return this->write_frame(FRAME_TYPE_STATE_SET, req);
+            req->data.gate_position == tion4s_state_t::GATE_POSITION_OUTDOOR ? "inflow" : "recirculation");
+  TION_DUMP(TAG, "temp : %u", req->data.target_temperature);
+  TION_DUMP(TAG, "fan  : %u", req->data.fan_speed);
+  return req.write(FRAME_TYPE_STATE_SET);
 }
 
 bool Tion4sApi::reset_filter(const TionState &state, uint32_t request_id) const {
@@ -202,10 +255,10 @@ bool Tion4sApi::reset_filter(const TionState &state, uint32_t request_id) const
     TION_LOGW(TAG, "State was not initialized");
     return false;
   }
-  tion4s_raw_state_set_req_t req(request_id, state);
-  req.data.filter_reset = true;
-  req.data.filter_time = 0;
-  return this->write_frame(FRAME_TYPE_STATE_SET, req);
+  TionFrameBuilder<tion4s_raw_state_set_req_t> req(*this, request_id, state);
+  req->data.filter_reset = true;
+  req->data.filter_time = 0;
+  return req.write(FRAME_TYPE_STATE_SET);
 }
 
 bool Tion4sApi::factory_reset(const TionState &state, uint32_t request_id) const {
@@ -214,15 +267,16 @@ bool Tion4sApi::factory_reset(const TionState &state, uint32_t request_id) const
     TION_LOGW(TAG, "State was not initialized");
     return false;
   }
-  tion4s_raw_state_set_req_t req(request_id, state);
-  req.data.factory_reset = true;
-  return this->write_frame(FRAME_TYPE_STATE_SET, req);
+  TionFrameBuilder<tion4s_raw_state_set_req_t> req(*this, request_id, state);
+  req->data.factory_reset = true;
+  return req.write(FRAME_TYPE_STATE_SET);
 }
 
 bool Tion4sApi::set_turbo(uint16_t time, uint32_t request_id) const {
   TION_LOGD(TAG, "Request[%" PRIu32 "] Turbo %u", request_id, time);
-  const tion4s_raw_frame_t<tion4s_turbo_set_t> req{.request_id = request_id, .data = {.time = time, .err_code = 0}};
-  return this->write_frame(FRAME_TYPE_TURBO_SET, req);
+  TionFrameBuilder<tion4s_raw_frame_t<tion4s_turbo_set_t>> req(*this, request_id,
+                                                               tion4s_turbo_set_t{.time = time, .err_code = 0});
+  return req.write(FRAME_TYPE_TURBO_SET);
 };
 
 #ifdef TION_ENABLE_HEARTBEAT
@@ -295,19 +349,26 @@ bool Tion4sApi::reset_errors(const TionState &state, uint32_t request_id) const
     TION_LOGW(TAG, "State was not initialized");
     return false;
   }
-  tion4s_raw_state_set_req_t req(request_id, state);
-  req.data.error_reset = true;
-  return this->write_frame(FRAME_TYPE_STATE_SET, req);
+  TionFrameBuilder<tion4s_raw_state_set_req_t> req(*this, request_id, state);
+  req->data.error_reset = true;
+  return req.write(FRAME_TYPE_STATE_SET);
 }
 
 void Tion4sApi::request_state() {
+  using request_type = tion::TionPollCycle::request_type;
+  this->poll_.begin();
   if (this->state_.firmware_version == 0) {
-    this->request_dev_info_();
+    this->poll_.add(FRAME_TYPE_DEV_INFO_RSP, request_type::create<Tion4sApi, &Tion4sApi::request_dev_info_>(*this));
   }
-  if (this->traits_.supports_boost) {
-    this->request_turbo_();
+  if (this->traits_.supports<tion::FEATURE_BOOST>()) {
+    if (this->state_.boost_time_left > 0 || this->turbo_poll_cycles_ == 0) {
+      this->turbo_poll_cycles_ = TURBO_POLL_CYCLES;
+      this->poll_.add(FRAME_TYPE_TURBO_RSP, request_type::create<Tion4sApi, &Tion4sApi::request_turbo_>(*this));
+    }
+    this->turbo_poll_cycles_--;
   }
-  this->request_state_();
+  this->poll_.add(FRAME_TYPE_STATE_RSP, request_type::create<Tion4sApi, &Tion4sApi::request_state_>(*this));
+  this->poll_.start();
 }
 
 Tion4sApi::Tion4sApi() {
@@ -414,12 +475,12 @@ void Tion4sApi::update_turbo_(const tion4s_turbo_t &turbo) {
 }
 
 void Tion4sApi::boost_enable_native_(bool state) {
-  if (!this->traits_.supports_boost) {
+  if (!this->traits_.supports<tion::FEATURE_BOOST>()) {
     TION_LOGW(TAG, "Native boost is unsupported");
     return;
   }
   TION_LOGD(TAG, "Enable native boost: %s", ONOFF(state));
-  this->set_turbo(this->traits_.boost_time, ++this->request_id_);
+  this->set_turbo(this->traits_.boost_time, this->next_request_id_());
 }
 
 }  // namespace tion_4s
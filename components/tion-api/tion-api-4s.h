@@ -3,6 +3,9 @@
 #include <functional>
 
 #include "tion-api-writer.h"
+#include "tion-api-tx-queue.h"
+#include "tion-api-request-tracker.h"
+#include "tion-api-poll.h"
 #include "tion-api-4s-internal.h"
 
 namespace dentra {
@@ -21,12 +24,22 @@ class Tion4sApi : public tion::TionApiBase, public tion::TionApiWriter {
 #endif
 
  public:
+  /// Features known at compile time.
+  using static_traits_type = tion::Tion4sStaticTraits;
+
   Tion4sApi();
 
   void read_frame(uint16_t frame_type, const void *frame_data, size_t frame_data_size);
 
   uint16_t get_state_type() const;
 
+  /// Returns TX queue policy of the frame.
+  static tion::TionTxPolicy get_tx_policy(uint16_t type, const void *data, size_t size);
+  /// Returns response type and request id of the request frame.
+  static tion::tion_request_info_t get_request_info(uint16_t type, const void *data, size_t size);
+  /// Returns request id of the response frame.
+  static uint32_t get_response_id(uint16_t type, const void *data, size_t size);
+
   bool write_state(const tion::TionState &state, uint32_t request_id) const;
   bool reset_filter(const tion::TionState &state, uint32_t request_id = 1) const;
   bool factory_reset(const tion::TionState &state, uint32_t request_id = 1) const;
@@ -43,7 +56,7 @@ class Tion4sApi : public tion::TionApiBase, public tion::TionApiWriter {
 
 #ifdef TION_ENABLE_SCHEDULER
   bool request_time(uint32_t request_id) const;
-  void request_time() { this->request_time(++this->request_id_); }
+  void request_time() { this->request_time(this->next_request_id_()); }
 
   /// Callback listener for response to request_time command request.
   on_time_type on_time{};
@@ -52,18 +65,18 @@ class Tion4sApi : public tion::TionApiBase, public tion::TionApiWriter {
   /// Callback listener for response to request_timer command request.
   on_timer_type on_timer{};
   bool request_timer(uint8_t timer_id, uint32_t request_id) const;
-  void request_timer(uint8_t timer_id) { this->request_timer(timer_id, ++this->request_id_); }
+  void request_timer(uint8_t timer_id) { this->request_timer(timer_id, this->next_request_id_()); }
 
   /// Request all timers.
   bool request_timers(uint32_t request_id = 1) const;
 
   bool write_timer(uint8_t timer_id, const tion4s_timer_t &timer, uint32_t request_id) const;
   void write_timer(uint8_t timer_id, const tion4s_timer_t &timer) {
-    this->write_timer(timer_id, timer, ++this->request_id_);
+    this->write_timer(timer_id, timer, this->next_request_id_());
   }
 
   bool request_timers_state(uint32_t request_id) const;
-  void request_timers_state() { this->request_timers_state(++this->request_id_); }
+  void request_timers_state() { this->request_timers_state(this->next_request_id_()); }
   /// Callback listener for response to request_timers_state command request.
   on_timers_state_type on_timers_state{};
 
@@ -75,13 +88,36 @@ class Tion4sApi : public tion::TionApiBase, public tion::TionApiWriter {
 
   void enable_native_boost_support();
   void request_state() override;
+
+  /// Sets max number of poll requests waiting for a response.
+  void set_poll_window(uint8_t window) { this->poll_.set_window(window); }
+  const tion::TionPollCycle &get_poll() const { return this->poll_; }
+  void loop() override {
+    TionApiBase::loop();
+    this->poll_.loop();
+  }
   void write_state(tion::TionStateCall *call) override {
-    this->write_state(this->make_write_state_(call), ++this->request_id_);
+    const auto state = this->make_write_state_(call);
+    if (this->write_suppressed_(state)) {
+      return;
+    }
+    const auto request_id = this->next_request_id_();
+    if (this->write_state(state, request_id)) {
+      this->state_written_(state, request_id);
+    }
   }
-  void reset_filter() override { this->reset_filter(this->state_, ++this->request_id_); }
+  void reset_filter() override { this->reset_filter(this->state_, this->next_request_id_()); }
 
  protected:
+  // Turbo state is requested each cycle while boost is active, otherwise once per number of cycles.
+  enum { TURBO_POLL_CYCLES = 8 };
+  tion::TionPollCycle poll_;
+  uint8_t turbo_poll_cycles_{};
+
   void boost_enable_native_(bool state) override;
+  bool write_retry_(const tion::TionState &state, uint32_t request_id) override {
+    return this->write_state(state, request_id);
+  }
 
   bool request_turbo_() const;
   bool request_dev_info_() const;
@@ -1,6 +1,7 @@
 #include <utility>
 #include <cstring>
 #include <cstdlib>
+#include <cinttypes>
 
 #include "crc.h"
 #include "utils.h"
@@ -26,9 +27,17 @@ struct TionLtRawBlePacket {
     // last packet 0xC0.
     TYPE_LAST = 3 << 6,
   };
-  enum { MAX_MTU_SIZE = 20 };
+  enum {
+    // ATT write request header size.
+    ATT_HEAD_SIZE = 3,
+    // default ATT MTU.
+    DEFAULT_MTU = 23,
+    // max ATT MTU payload within a single LE data packet.
+    MAX_MTU = 247,
+    MAX_SIZE = MAX_MTU - ATT_HEAD_SIZE,
+  };
   uint8_t type;
-  uint8_t data[MAX_MTU_SIZE - 1];
+  uint8_t data[MAX_SIZE - 1];
 };
 struct TionLtRawBleFrame {
   enum { FRAME_MAGIC = 0x3A };
@@ -39,6 +48,20 @@ struct TionLtRawBleFrame {
 };
 #pragma pack(pop)
 
+TionLtBleProtocol::TionLtBleProtocol(bool rx_crc) : rx_crc_(rx_crc) {
+  this->set_mtu(TionLtRawBlePacket::DEFAULT_MTU);
+}
+
+void TionLtBleProtocol::set_mtu(uint16_t mtu) {
+  if (mtu < TionLtRawBlePacket::DEFAULT_MTU) {
+    mtu = TionLtRawBlePacket::DEFAULT_MTU;
+  } else if (mtu > TionLtRawBlePacket::MAX_MTU) {
+    mtu = TionLtRawBlePacket::MAX_MTU;
+  }
+  this->tx_packet_size_ = mtu - TionLtRawBlePacket::ATT_HEAD_SIZE;
+  TION_LOGV(TAG, "MTU %u, packet size %u", mtu, this->tx_packet_size_);
+}
+
 const char *TionLtBleProtocol::get_ble_service() const { return "98f00001-3788-83ea-453e-f52244709ddb"; }
 const char *TionLtBleProtocol::get_ble_char_tx() const { return "98f00002-3788-83ea-453e-f52244709ddb"; };
 const char *TionLtBleProtocol::get_ble_char_rx() const { return "98f00003-3788-83ea-453e-f52244709ddb"; }
@@ -53,31 +76,59 @@ bool TionLtBleProtocol::read_data(const uint8_t *data, size_t size) {
   auto *pkt = reinterpret_cast<const TionLtRawBlePacket *>(data);
   auto data_size = size - sizeof(pkt->type);
 
+  const uint32_t now = tion::millis();
+  if (this->rx_state_ == RX_BUSY && now - this->rx_time_ > RX_TIMEOUT) {
+    TION_LOGW(TAG, "Frame timeout after %" PRIu32 " ms", now - this->rx_time_);
+    this->rx_stats_.timeouts++;
+    // rest of the frame is skipped
+    this->rx_state_ = RX_SKIP;
+  }
+  this->rx_time_ = now;
+
+  if (pkt->type == TionLtRawBlePacket::TYPE_LONE || pkt->type == TionLtRawBlePacket::TYPE_FRST) {
+    if (this->rx_state_ == RX_BUSY) {
+      TION_LOGW(TAG, "Orphaned frame of %u bytes", this->rx_size_);
+      this->rx_stats_.orphaned++;
+    }
+    this->rx_state_ = RX_IDLE;
+  }
+
   if (pkt->type == TionLtRawBlePacket::TYPE_LONE) {
     TION_LOGV(TAG, "Packet LONE");
-    this->read_frame_(pkt->data, data_size);
+    this->read_frame_(pkt->data, data_size, this->rx_crc_ ? crc16_ccitt_false_ffff(pkt->data, data_size) : 0);
     return true;
   }
 
   if (pkt->type == TionLtRawBlePacket::TYPE_FRST) {
     TION_LOGV(TAG, "Packet FRST");
-    this->rx_buf_.clear();
-    this->rx_buf_.insert(this->rx_buf_.end(), pkt->data, pkt->data + data_size);
-    return true;
-  }
-
-  if (pkt->type == TionLtRawBlePacket::TYPE_CURR) {
-    TION_LOGV(TAG, "Packet CURR");
-    this->rx_buf_.insert(this->rx_buf_.end(), pkt->data, pkt->data + data_size);
-    return true;
+    this->rx_state_ = RX_BUSY;
+    this->rx_size_ = 0;
+    if (this->rx_crc_) {
+      this->rx_buf_crc_.reset();
+    }
+    return this->append_rx_buf_(pkt->data, data_size);
   }
 
-  if (pkt->type == TionLtRawBlePacket::TYPE_LAST) {
-    TION_LOGV(TAG, "Packet LAST");
-    this->rx_buf_.insert(rx_buf_.end(), pkt->data, pkt->data + data_size);
-    this->read_frame_(this->rx_buf_.data(), this->rx_buf_.size());
-    this->rx_buf_.clear();
-    this->rx_buf_.shrink_to_fit();
+  if (pkt->type == TionLtRawBlePacket::TYPE_CURR || pkt->type == TionLtRawBlePacket::TYPE_LAST) {
+    const bool last = pkt->type == TionLtRawBlePacket::TYPE_LAST;
+    TION_LOGV(TAG, "Packet %s", last ? "LAST" : "CURR");
+    if (this->rx_state_ == RX_IDLE) {
+      TION_LOGW(TAG, "Orphaned packet 0x%02X", pkt->type);
+      this->rx_stats_.orphaned++;
+      return false;
+    }
+    if (this->rx_state_ == RX_SKIP) {
+      this->rx_state_ = last ? RX_IDLE : RX_SKIP;
+      return false;
+    }
+    if (!this->append_rx_buf_(pkt->data, data_size)) {
+      this->rx_state_ = last ? RX_IDLE : RX_SKIP;
+      return false;
+    }
+    if (last) {
+      this->rx_state_ = RX_IDLE;
+      this->read_frame_(this->rx_buf_, this->rx_size_, this->rx_buf_crc_.value());
+    }
     return true;
   }
 
@@ -85,14 +136,33 @@ bool TionLtBleProtocol::read_data(const uint8_t *data, size_t size) {
   return false;
 }
 
+bool TionLtBleProtocol::append_rx_buf_(const uint8_t *data, size_t size) {
+  if (this->rx_size_ + size > sizeof(this->rx_buf_)) {
+    TION_LOGW(TAG, "Frame is too large: %zu", this->rx_size_ + size);
+    this->rx_stats_.overflowed++;
+    this->rx_state_ = RX_SKIP;
+    return false;
+  }
+  std::memcpy(&this->rx_buf_[this->rx_size_], data, size);
+  this->rx_size_ += size;
+  if (this->rx_crc_) {
+    this->rx_buf_crc_.update(data, size);
+  }
+  return true;
+}
+
 // TODO remove return type
-bool TionLtBleProtocol::read_frame_(const void *data, uint32_t size) {
+bool TionLtBleProtocol::read_frame_(const void *data, uint32_t size, uint16_t crc) {
   TION_LOGV(TAG, "Read frame: %s", hex_cstr(data, size));
   if (!this->reader) {
     TION_LOGE(TAG, "Reader is not configured");
     return false;
   }
 
+  if (size < sizeof(TionLtRawBleFrame)) {
+    TION_LOGW(TAG, "Invalid frame size: %" PRIu32, size);
+    return false;
+  }
   const TionLtRawBleFrame *frame = static_cast<const TionLtRawBleFrame *>(data);
   if (frame->magic != TionLtRawBleFrame::FRAME_MAGIC) {
     TION_LOGW(TAG, "Invalid frame magic: 0x%02X", frame->magic);
@@ -103,12 +173,12 @@ bool TionLtBleProtocol::read_frame_(const void *data, uint32_t size) {
     return false;
   }
   if (this->rx_crc_) {
-    const uint16_t crc = crc16_ccitt_false_ffff(frame, size);
     if (crc != 0) {
       TION_LOGW(TAG, "Invalid frame crc: %04X", crc);
       return false;
     }
   }
+  this->rx_stats_.frames++;
   this->reader(*reinterpret_cast<const tion_any_ble_frame_t *>(&frame->data),
                frame->size - sizeof(TionLtRawBleFrame) + sizeof(tion_any_ble_frame_t));
   return true;
@@ -117,54 +187,65 @@ bool TionLtBleProtocol::read_frame_(const void *data, uint32_t size) {
 bool TionLtBleProtocol::write_frame(uint16_t frame_type, const void *frame_data, size_t frame_data_size) {
   TION_LOGV(TAG, "Write frame 0x%04X: %s", frame_type, hex_cstr(frame_data, frame_data_size));
 
-  uint8_t tx_buf[frame_data_size + sizeof(TionLtRawBleFrame)];
-  auto *tx_frame = reinterpret_cast<TionLtRawBleFrame *>(tx_buf);
-
-  tx_frame->magic = TionLtRawBleFrame::FRAME_MAGIC;
-  tx_frame->random = 0xAD;
-  tx_frame->size = sizeof(tx_buf);
-  tx_frame->data.type = frame_type;
-  tx_frame->data.ble_request_id = 1;  // TODO возможно можно инкрементировать и проверять в ответе
-  std::memcpy(tx_frame->data.data, frame_data, frame_data_size);
-
-  uint16_t crc = __builtin_bswap16(crc16_ccitt_false_ffff(tx_frame, sizeof(tx_buf) - sizeof(crc)));
-  std::memcpy(&tx_frame->data.data[frame_data_size], &crc, sizeof(crc));
-
-  return this->write_packet_(tx_frame, sizeof(tx_buf));
-}
-
-bool TionLtBleProtocol::write_packet_(const void *data, uint16_t size) const {
-  TION_LOGV(TAG, "Write BLE packet: %s", hex_cstr(data, size));
-
   if (!this->writer) {
     TION_LOGE(TAG, "Writer is not configured");
     return false;
   }
 
-  TionLtRawBlePacket pkt;
+  // frame head and crc are filled in place, data is written to packets directly from frame_data.
+  TionLtRawBleFrame frame;
+  constexpr size_t head_size = sizeof(frame) - sizeof(frame.data.data);
+  frame.magic = TionLtRawBleFrame::FRAME_MAGIC;
+  frame.random = 0xAD;
+  frame.size = sizeof(frame) + frame_data_size;
+  frame.data.type = frame_type;
+  frame.data.ble_request_id = 1;  // TODO возможно можно инкрементировать и проверять в ответе
 
-  size_t data_packet_size = sizeof(pkt.data);
-  const uint8_t *data_ptr = static_cast<const uint8_t *>(data);
+  const uint16_t crc_value = Crc16Ccitt().update(&frame, head_size).update(frame_data, frame_data_size).value();
+  const uint16_t crc = __builtin_bswap16(crc_value);
+  std::memcpy(frame.data.data, &crc, sizeof(crc));
 
-  data_packet_size = size > data_packet_size ? data_packet_size : size;
-  size -= data_packet_size;
-  pkt.type = size ? TionLtRawBlePacket::TYPE_FRST : TionLtRawBlePacket::TYPE_LONE;
-  std::memcpy(pkt.data, data_ptr, data_packet_size);
-  data_ptr += data_packet_size;
+  const struct {
+    const uint8_t *data;
+    size_t size;
+  } segs[] = {
+      {reinterpret_cast<const uint8_t *>(&frame), head_size},
+      {static_cast<const uint8_t *>(frame_data), frame_data_size},
+      {frame.data.data, sizeof(crc)},
+  };
+  size_t seg = 0;
+  size_t seg_pos = 0;
 
-  if (!this->writer(reinterpret_cast<uint8_t *>(&pkt), data_packet_size + sizeof(pkt.type))) {
-    TION_LOGW(TAG, "Can't write packet");
-    return false;
-  }
+  TionLtRawBlePacket pkt;
+  const size_t pkt_data_max = this->tx_packet_size_ - sizeof(pkt.type);
+  size_t left = frame.size;
+  bool first = true;
+  while (left > 0) {
+    const size_t pkt_data_size = left < pkt_data_max ? left : pkt_data_max;
+    left -= pkt_data_size;
+    if (first) {
+      pkt.type = left ? TionLtRawBlePacket::TYPE_FRST : TionLtRawBlePacket::TYPE_LONE;
+      first = false;
+    } else {
+      pkt.type = left ? TionLtRawBlePacket::TYPE_CURR : TionLtRawBlePacket::TYPE_LAST;
+    }
 
-  while (size) {
-    data_packet_size = size > data_packet_size ? data_packet_size : size;
-    size -= data_packet_size;
-    pkt.type = size ? TionLtRawBlePacket::TYPE_CURR : TionLtRawBlePacket::TYPE_LAST;
-    std::memcpy(pkt.data, data_ptr, data_packet_size);
-    data_ptr += data_packet_size;
+    // gather packet data from frame segments
+    for (size_t pos = 0; pos < pkt_data_size;) {
+      const size_t seg_left = segs[seg].size - seg_pos;
+      if (seg_left == 0) {
+        seg++;
+        seg_pos = 0;
+        continue;
+      }
+      const size_t size = seg_left < pkt_data_size - pos ? seg_left : pkt_data_size - pos;
+      std::memcpy(&pkt.data[pos], segs[seg].data + seg_pos, size);
+      seg_pos += size;
+      pos += size;
+    }
 
-    if (!this->writer(reinterpret_cast<uint8_t *>(&pkt), data_packet_size + sizeof(pkt.type))) {
+    TION_LOGV(TAG, "Write BLE packet: %s", hex_cstr(&pkt, pkt_data_size + sizeof(pkt.type)));
+    if (!this->writer(reinterpret_cast<uint8_t *>(&pkt), pkt_data_size + sizeof(pkt.type))) {
       TION_LOGW(TAG, "Can't write packet");
       return false;
     }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "crc.h"
 #include "tion-api-protocol.h"
 
 namespace dentra {
@@ -7,7 +8,19 @@ namespace tion {
 
 class TionLtBleProtocol : public TionProtocol<tion_any_ble_frame_t> {
  public:
-  TionLtBleProtocol(bool rx_crc = true) : rx_crc_(rx_crc) {}
+  TionLtBleProtocol(bool rx_crc = true);
+
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  struct rx_stats_t {
+    // Number of successfully received frames.
+    uint32_t frames;
+    // Number of packets or reassemblies dropped due to unexpected packet sequence.
+    uint32_t orphaned;
+    // Number of reassemblies dropped due to rx buffer overflow.
+    uint32_t overflowed;
+    // Number of reassemblies dropped due to timeout between packets.
+    uint32_t timeouts;
+  };
 
   bool read_data(const uint8_t *data, size_t size);
 
@@ -17,12 +30,49 @@ class TionLtBleProtocol : public TionProtocol<tion_any_ble_frame_t> {
   const char *get_ble_char_tx() const;
   const char *get_ble_char_rx() const;
 
+  const rx_stats_t &get_rx_stats() const { return this->rx_stats_; }
+
+  /// Sets negotiated ATT MTU, so a frame is written with fewer packets.
+  void set_mtu(uint16_t mtu);
+
  protected:
+  enum {
+#ifdef TION_UPDATE_EMU
+    // firmware update chunk: 516 bytes of data with 12 bytes of frame head and crc.
+    RX_BUF_SIZE = 528,
+#else
+    // 4S test response: 440 bytes of data with 12 bytes of frame head and crc.
+    RX_BUF_SIZE = 452,
+#endif
+    // max time between packets of a frame.
+    RX_TIMEOUT = 1000,
+  };
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  enum rx_state_t : uint8_t {
+    // waiting FRST or LONE packet.
+    RX_IDLE,
+    // reassembling a frame.
+    RX_BUSY,
+    // skipping CURR and LAST packets of a dropped frame.
+    RX_SKIP,
+  };
+
   bool rx_crc_;
-  std::vector<uint8_t> rx_buf_;
+  rx_state_t rx_state_{};
+  uint16_t rx_size_{};
+  // time of the last received packet
+  uint32_t rx_time_{};
+  uint8_t rx_buf_[RX_BUF_SIZE];
+  // crc of rx_buf_ calculated as packets arrive
+  Crc16Ccitt rx_buf_crc_;
+  rx_stats_t rx_stats_{};
+
+  // max size of a written packet.
+  uint16_t tx_packet_size_;
+
+  bool append_rx_buf_(const uint8_t *data, size_t size);
 
-  bool write_packet_(const void *data, uint16_t size) const;
-  bool read_frame_(const void *data, uint32_t size);
+  bool read_frame_(const void *data, uint32_t size, uint16_t crc);
 };
 
 }  // namespace tion
@@ -0,0 +1,194 @@
+#include <cstring>
+
+#include "tion-api.h"
+#include "tion-api-codec.h"
+
+namespace dentra {
+namespace tion {
+
+namespace {
+
+class Writer {
+ public:
+  explicit Writer(uint8_t *buf) : buf_(buf), pos_(buf) {}
+  void u8(uint8_t value) { *this->pos_++ = value; }
+  void i8(int8_t value) { this->u8(static_cast<uint8_t>(value)); }
+  void u16(uint16_t value) {
+    this->u8(value);
+    this->u8(value >> 8);
+  }
+  void u32(uint32_t value) {
+    this->u16(value);
+    this->u16(value >> 16);
+  }
+  void f32(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    this->u32(bits);
+  }
+  size_t size() const { return this->pos_ - this->buf_; }
+
+ protected:
+  uint8_t *buf_;
+  uint8_t *pos_;
+};
+
+class Reader {
+ public:
+  explicit Reader(const uint8_t *data) : pos_(data) {}
+  uint8_t u8() { return *this->pos_++; }
+  int8_t i8() { return static_cast<int8_t>(this->u8()); }
+  uint16_t u16() {
+    const uint16_t lo = this->u8();
+    return lo | (this->u8() << 8);
+  }
+  uint32_t u32() {
+    const uint32_t lo = this->u16();
+    return lo | (static_cast<uint32_t>(this->u16()) << 16);
+  }
+  float f32() {
+    const uint32_t bits = this->u32();
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+ protected:
+  const uint8_t *pos_;
+};
+
+bool check_header(Reader &rd, size_t size, uint8_t type, size_t min_size) {
+  if (size < min_size) {
+    return false;
+  }
+  if (rd.u8() != type) {
+    return false;
+  }
+  // newer minor versions only append fields
+  return rd.u8() >> 4 == TionCodec::VERSION_MAJOR;
+}
+
+}  // namespace
+
+size_t TionCodec::encode(const TionState &state, uint8_t *buf) {
+  Writer wr(buf);
+  wr.u8(TYPE_STATE);
+  wr.u8(VERSION);
+  wr.u8(state.power_state << 0 | state.heater_state << 1 | state.sound_state << 2 | state.led_state << 3 |
+        state.auto_state << 4 | state.filter_state << 5 | state.gate_error_state << 6 |
+        static_cast<uint8_t>(state.comm_source) << 7);
+  wr.u8(state.initialized | state.fan_speed << 1 | static_cast<uint8_t>(state.gate_position) << 4);
+  wr.i8(state.outdoor_temperature);
+  wr.i8(state.current_temperature);
+  wr.i8(state.target_temperature);
+  wr.u8(state.productivity);
+  wr.u8(state.heater_var);
+  wr.u32(state.work_time);
+  wr.u32(state.fan_time);
+  wr.u32(state.filter_time_left);
+  wr.u32(state.airflow_counter);
+  wr.f32(state.airflow_m3);
+  wr.u16(state.boost_time_left);
+  wr.u16(state.firmware_version);
+  wr.u16(state.hardware_version);
+  wr.i8(state.pcb_ctl_temperature);
+  wr.i8(state.pcb_pwr_temperature);
+  wr.u32(state.errors);
+  return wr.size();
+}
+
+bool TionCodec::decode(const uint8_t *data, size_t size, TionState *state) {
+  Reader rd(data);
+  if (!check_header(rd, size, TYPE_STATE, STATE_SIZE)) {
+    return false;
+  }
+  const auto flags = rd.u8();
+  state->power_state = flags & (1 << 0);
+  state->heater_state = flags & (1 << 1);
+  state->sound_state = flags & (1 << 2);
+  state->led_state = flags & (1 << 3);
+  state->auto_state = flags & (1 << 4);
+  state->filter_state = flags & (1 << 5);
+  state->gate_error_state = flags & (1 << 6);
+  state->comm_source = static_cast<CommSource>(flags >> 7);
+  const auto fan = rd.u8();
+  state->initialized = fan & 1;
+  state->fan_speed = (fan >> 1) & 0x7;
+  state->gate_position = static_cast<TionGatePosition>(fan >> 4);
+  state->outdoor_temperature = rd.i8();
+  state->current_temperature = rd.i8();
+  state->target_temperature = rd.i8();
+  state->productivity = rd.u8();
+  state->heater_var = rd.u8();
+  state->work_time = rd.u32();
+  state->fan_time = rd.u32();
+  state->filter_time_left = rd.u32();
+  state->airflow_counter = rd.u32();
+  state->airflow_m3 = rd.f32();
+  state->boost_time_left = rd.u16();
+  state->firmware_version = rd.u16();
+  state->hardware_version = rd.u16();
+  state->pcb_ctl_temperature = rd.i8();
+  state->pcb_pwr_temperature = rd.i8();
+  state->errors = rd.u32();
+  return true;
+}
+
+size_t TionCodec::encode(const TionTraits &traits, uint8_t *buf) {
+  Writer wr(buf);
+  wr.u8(TYPE_TRAITS);
+  wr.u8(VERSION);
+  wr.u16(traits.supports_led_state << 0 | traits.supports_sound_state << 1 |
+         traits.supports_gate_position_change << 2 | traits.supports_gate_position_change_mixed << 3 |
+         traits.supports_heater_var << 4 | traits.supports_work_time << 5 | traits.supports_fan_time << 6 |
+         traits.supports_airflow_counter << 7 | traits.supports_gate_error << 8 |
+         traits.supports_pcb_ctl_temperatire << 9 | traits.supports_pcb_pwr_temperature << 10 |
+         traits.supports_manual_antifrize << 11 | traits.supports_boost << 12 | traits.supports_reset_filter << 13);
+  wr.u16(traits.boost_time);
+  wr.i8(traits.boost_heater_state);
+  wr.i8(traits.boost_target_temperature);
+  wr.u8(traits.max_fan_speed);
+  wr.i8(traits.min_target_temperature);
+  wr.i8(traits.max_target_temperature);
+  wr.u8(traits.max_heater_power);
+  for (auto power : traits.max_fan_power) {
+    wr.u16(power);
+  }
+  return wr.size();
+}
+
+bool TionCodec::decode(const uint8_t *data, size_t size, TionTraits *traits) {
+  Reader rd(data);
+  if (!check_header(rd, size, TYPE_TRAITS, TRAITS_SIZE)) {
+    return false;
+  }
+  const auto flags = rd.u16();
+  traits->supports_led_state = flags & (1 << 0);
+  traits->supports_sound_state = flags & (1 << 1);
+  traits->supports_gate_position_change = flags & (1 << 2);
+  traits->supports_gate_position_change_mixed = flags & (1 << 3);
+  traits->supports_heater_var = flags & (1 << 4);
+  traits->supports_work_time = flags & (1 << 5);
+  traits->supports_fan_time = flags & (1 << 6);
+  traits->supports_airflow_counter = flags & (1 << 7);
+  traits->supports_gate_error = flags & (1 << 8);
+  traits->supports_pcb_ctl_temperatire = flags & (1 << 9);
+  traits->supports_pcb_pwr_temperature = flags & (1 << 10);
+  traits->supports_manual_antifrize = flags & (1 << 11);
+  traits->supports_boost = flags & (1 << 12);
+  traits->supports_reset_filter = flags & (1 << 13);
+  traits->boost_time = rd.u16();
+  traits->boost_heater_state = rd.i8();
+  traits->boost_target_temperature = rd.i8();
+  traits->max_fan_speed = rd.u8();
+  traits->min_target_temperature = rd.i8();
+  traits->max_target_temperature = rd.i8();
+  traits->max_heater_power = rd.u8();
+  for (auto &power : traits->max_fan_power) {
+    power = rd.u16();
+  }
+  return true;
+}
+
+}  // namespace tion
+}  // namespace dentra
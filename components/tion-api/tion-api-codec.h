@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace dentra {
+namespace tion {
+
+class TionState;
+struct TionTraits;
+
+/// Versioned little-endian encoding of TionState and TionTraits independent of the struct layout.
+/// Encoded data starts with a type and a version bytes. High nibble of the version is major, low one is minor.
+/// Newer minor versions only append fields, so data of any minor version of the same major is decoded.
+/// Traits pointers (errors decoder and auto productivity) are not encoded and are kept on decode.
+class TionCodec {
+ public:
+  enum : uint8_t {
+    VERSION_MAJOR = 1,
+    VERSION_MINOR = 0,
+    VERSION = VERSION_MAJOR << 4 | VERSION_MINOR,
+    TYPE_STATE = 'S',
+    TYPE_TRAITS = 'T',
+  };
+
+  /// Size of encoded TionState.
+  constexpr static size_t STATE_SIZE = 41;
+  /// Size of encoded TionTraits.
+  constexpr static size_t TRAITS_SIZE = 26;
+
+  /// Encodes state to buf of at least STATE_SIZE bytes. Returns number of written bytes.
+  static size_t encode(const TionState &state, uint8_t *buf);
+  /// Encodes traits to buf of at least TRAITS_SIZE bytes. Returns number of written bytes.
+  static size_t encode(const TionTraits &traits, uint8_t *buf);
+
+  /// Decodes state. Returns false if data has invalid type, other major version or is too short.
+  /// Fields appended by newer minor versions are ignored.
+  static bool decode(const uint8_t *data, size_t size, TionState *state);
+  /// Decodes traits. Returns false if data has invalid type, other major version or is too short.
+  /// Fields appended by newer minor versions are ignored.
+  static bool decode(const uint8_t *data, size_t size, TionTraits *traits);
+};
+
+}  // namespace tion
+}  // namespace dentra
@@ -8,6 +8,16 @@
 #define TION_BOOST_TIME TION_DEFAULT_BOOST_TIME
 #endif
 
+// Max number of presets, excluding reserved "none" preset.
+#ifndef TION_MAX_PRESETS
+#define TION_MAX_PRESETS 8
+#endif
+
+// Time in ms to wait for the breezer to confirm optimistic state.
+#ifndef TION_OPTIMISTIC_TIMEOUT
+#define TION_OPTIMISTIC_TIMEOUT 5000
+#endif
+
 #ifndef TION_MAX_TEMPERATURE
 #define TION_MAX_TEMPERATURE TION_DEFAULT_MAX_TEMPERATURE
 #endif
@@ -160,6 +170,17 @@
 #define TION_AUTO_KP 0.2736
 #define TION_AUTO_TI 8
 #define TION_AUTO_DB 20
+// Hysteresis of auto fan speed change [% of the speed airflow range], 0 disables it.
+#define TION_AUTO_HYSTERESIS 0
+// Min time to keep auto fan speed [ms], 0 disables it.
+#define TION_AUTO_MIN_DWELL 0
+// Max number of auto fan speed changes in a row and time to earn one more [ms], 0 burst disables it.
+#define TION_AUTO_RATE_LIMIT_BURST 0
+#define TION_AUTO_RATE_LIMIT_INTERVAL 0
+// EWMA smoothing factor of auto mode sensors after median filter, 1 disables smoothing.
+#define TION_AUTO_SMOOTHING 0.5f
+// Time after the last sample to treat auto mode sensor as stale [ms].
+#define TION_AUTO_SENSOR_TIMEOUT (15 * 60 * 1000)
 
 #define TION_O2_AUTO_PROD 35, 60, 75, 120
 #define TION_3S_AUTO_PROD 15, 30, 50, 60, 75, 100
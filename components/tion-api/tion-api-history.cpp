@@ -0,0 +1,79 @@
+#include <cstring>
+
+#include "utils.h"
+
+#include "tion-api.h"
+#include "tion-api-history.h"
+
+namespace dentra {
+namespace tion {
+
+bool TionStateHistoryBase::push(const TionState &state) {
+  tion_history_record_t rec{};
+  rec.outdoor_temperature = state.outdoor_temperature;
+  rec.current_temperature = state.current_temperature;
+  rec.target_temperature = state.target_temperature;
+  rec.heater_var = state.heater_var;
+  rec.fan_speed = state.fan_speed;
+  rec.gate_position = static_cast<uint8_t>(state.gate_position);
+  rec.flags.power_state = state.power_state;
+  rec.flags.heater_state = state.heater_state;
+  rec.flags.sound_state = state.sound_state;
+  rec.flags.led_state = state.led_state;
+  rec.flags.auto_state = state.auto_state;
+  rec.flags.filter_state = state.filter_state;
+  rec.flags.gate_error_state = state.gate_error_state;
+  rec.flags.boost_state = state.boost_time_left > 0;
+  rec.errors = state.errors;
+
+  const uint32_t now = tion::millis();
+  if (this->count_ == 0) {
+    this->base_time_ = now / 1000;
+    this->last_ms_ = now;
+  } else {
+    const auto last = this->at_(this->count_ - 1);
+    // time delta is the first field and is not compared
+    constexpr size_t offset = sizeof(rec.time_delta);
+    if (std::memcmp(reinterpret_cast<const uint8_t *>(&last) + offset, reinterpret_cast<const uint8_t *>(&rec) + offset,
+                    sizeof(rec) - offset) == 0) {
+      return false;
+    }
+    // wrap safe, as long as there are less than 49 days between records
+    uint32_t delta = (now - this->last_ms_) / 1000;
+    this->last_ms_ += delta * 1000;
+    // long time without changes is filled with copies of the last record, but no more than the whole history
+    for (size_t gaps = 0; delta > UINT16_MAX && gaps < this->capacity_; gaps++) {
+      auto gap = last;
+      gap.time_delta = UINT16_MAX;
+      this->add_(gap);
+      delta -= UINT16_MAX;
+    }
+    if (delta > UINT16_MAX) {
+      // the rest of the gap precedes the oldest record
+      this->base_time_ += delta - UINT16_MAX;
+      delta = UINT16_MAX;
+    }
+    rec.time_delta = delta;
+  }
+  this->add_(rec);
+  return true;
+}
+
+void TionStateHistoryBase::clear() {
+  this->tail_ = 0;
+  this->count_ = 0;
+}
+
+void TionStateHistoryBase::add_(const tion_history_record_t &record) {
+  if (this->count_ == this->capacity_) {
+    // time of the dropped record becomes the base
+    this->base_time_ += this->at_(0).time_delta;
+    this->count_--;
+  }
+  this->records_[this->tail_] = record;
+  this->tail_ = (this->tail_ + 1) % this->capacity_;
+  this->count_++;
+}
+
+}  // namespace tion
+}  // namespace dentra
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cinttypes>
+
+// Max number of records in the state history.
+#ifndef TION_HISTORY_SIZE
+#define TION_HISTORY_SIZE 256
+#endif
+
+namespace dentra {
+namespace tion {
+
+class TionState;
+
+#pragma pack(push, 1)
+// NOLINTNEXTLINE(readability-identifier-naming)
+struct tion_history_record_t {
+  // Seconds since the previous record.
+  uint16_t time_delta;
+  int8_t outdoor_temperature;
+  int8_t current_temperature;
+  int8_t target_temperature;
+  uint8_t heater_var;
+  uint8_t fan_speed : 4;
+  // TionGatePosition
+  uint8_t gate_position : 4;
+  struct {
+    bool power_state : 1;
+    bool heater_state : 1;
+    bool sound_state : 1;
+    bool led_state : 1;
+    bool auto_state : 1;
+    bool filter_state : 1;
+    bool gate_error_state : 1;
+    bool boost_state : 1;
+  } flags;
+  uint32_t errors;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(tion_history_record_t) == 12, "Invalid tion_history_record_t size");
+
+/// Header of binary history export, followed by count records from the oldest one.
+#pragma pack(push, 1)
+// NOLINTNEXTLINE(readability-identifier-naming)
+struct tion_history_header_t {
+  enum : uint8_t { VERSION = 1 };
+  char magic[2];
+  uint8_t version;
+  uint8_t record_size;
+  uint16_t count;
+  // Time in seconds of the record preceding the oldest one, all record times are relative to it.
+  uint32_t base_time;
+};
+#pragma pack(pop)
+
+/// Bounded history of state changes. Record is added only when any of stored fields is changed,
+/// the oldest record is overwritten when history is full. Time is delta encoded.
+class TionStateHistoryBase {
+ public:
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  struct entry_t {
+    // Seconds since boot.
+    uint32_t time;
+    const tion_history_record_t &record;
+  };
+
+  class iterator {
+   public:
+    iterator(const TionStateHistoryBase *history, size_t pos, uint32_t time) : h_(history), pos_(pos), time_(time) {
+      this->advance_time_();
+    }
+    entry_t operator*() const { return {this->time_, this->h_->at_(this->pos_)}; }
+    iterator &operator++() {
+      this->pos_++;
+      this->advance_time_();
+      return *this;
+    }
+    bool operator!=(const iterator &other) const { return this->pos_ != other.pos_; }
+
+   protected:
+    const TionStateHistoryBase *h_;
+    size_t pos_;
+    uint32_t time_;
+    void advance_time_() {
+      if (this->pos_ < this->h_->size()) {
+        this->time_ += this->h_->at_(this->pos_).time_delta;
+      }
+    }
+  };
+
+  /// Adds a record if any of stored fields is changed since the last record.
+  /// @return true if the record was added.
+  bool push(const TionState &state);
+  void clear();
+
+  size_t size() const { return this->count_; }
+  size_t capacity() const { return this->capacity_; }
+  bool empty() const { return this->count_ == 0; }
+
+  /// Iterates records from the oldest one.
+  iterator begin() const { return {this, 0, this->base_time_}; }
+  iterator end() const { return {this, this->count_, 0}; }
+
+  /// Writes binary tion_history_header_t followed by records.
+  template<typename Writer> void write_binary(Writer &&writer) const {
+    const tion_history_header_t header{
+        .magic = {'T', 'H'},
+        .version = tion_history_header_t::VERSION,
+        .record_size = sizeof(tion_history_record_t),
+        .count = static_cast<uint16_t>(this->count_),
+        .base_time = this->base_time_,
+    };
+    writer(reinterpret_cast<const char *>(&header), sizeof(header));
+    // stored records are at most in two contiguous parts
+    const size_t head = this->head_();
+    const size_t first = this->capacity_ - head < this->count_ ? this->capacity_ - head : this->count_;
+    writer(reinterpret_cast<const char *>(&this->records_[head]), first * sizeof(tion_history_record_t));
+    if (first < this->count_) {
+      writer(reinterpret_cast<const char *>(this->records_), (this->count_ - first) * sizeof(tion_history_record_t));
+    }
+  }
+
+  /// Writes CSV with header line, a line per record.
+  template<typename Writer> void write_csv(Writer &&writer) const {
+    static const char HEADER[] =
+        "time,power,heater,sound,led,auto,filter,gate_error,boost,fan_speed,gate_position,outdoor_temperature,"
+        "current_temperature,target_temperature,heater_var,errors\n";
+    writer(HEADER, sizeof(HEADER) - 1);
+    char buf[96];
+    for (const auto &entry : *this) {
+      const auto &rec = entry.record;
+      const int len =
+          std::snprintf(buf, sizeof(buf), "%" PRIu32 ",%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%d,%d,%d,%u,%08" PRIX32 "\n",
+                        entry.time, rec.flags.power_state, rec.flags.heater_state, rec.flags.sound_state,
+                        rec.flags.led_state, rec.flags.auto_state, rec.flags.filter_state, rec.flags.gate_error_state,
+                        rec.flags.boost_state, rec.fan_speed, rec.gate_position, rec.outdoor_temperature,
+                        rec.current_temperature, rec.target_temperature, rec.heater_var, rec.errors);
+      if (len > 0) {
+        writer(buf, static_cast<size_t>(len) < sizeof(buf) ? len : sizeof(buf) - 1);
+      }
+    }
+  }
+
+ protected:
+  TionStateHistoryBase(tion_history_record_t *records, size_t capacity) : records_(records), capacity_(capacity) {}
+
+  tion_history_record_t *records_;
+  size_t capacity_;
+  // index of the next record
+  size_t tail_{};
+  size_t count_{};
+  // time of the record preceding the oldest one
+  uint32_t base_time_{};
+  // millis() of the newest record, fractions of a second are carried to the next one
+  uint32_t last_ms_{};
+
+  size_t head_() const { return (this->tail_ + this->capacity_ - this->count_) % this->capacity_; }
+  const tion_history_record_t &at_(size_t pos) const { return this->records_[(this->head_() + pos) % this->capacity_]; }
+  void add_(const tion_history_record_t &record);
+};
+
+/// State history with storage for capacity_value records.
+template<size_t capacity_value> class TionStateHistory : public TionStateHistoryBase {
+  static_assert(capacity_value > 0 && capacity_value <= UINT16_MAX, "Invalid history capacity_value");
+
+ public:
+  TionStateHistory() : TionStateHistoryBase(this->storage_, capacity_value) {}
+  TionStateHistory(const TionStateHistory &) = delete;
+  TionStateHistory &operator=(const TionStateHistory &) = delete;
+
+ protected:
+  tion_history_record_t storage_[capacity_value]{};
+};
+
+}  // namespace tion
+}  // namespace dentra
@@ -1,4 +1,5 @@
 #include <cmath>
+#include <cstring>
 #include <cinttypes>
 
 #include "log.h"
@@ -21,6 +22,51 @@ static const uint8_t PROD[] = {0, TION_LT_AUTO_PROD};
 
 uint16_t TionLtApi::get_state_type() const { return FRAME_TYPE_STATE_RSP; }
 
+TionTxPolicy TionLtApi::get_tx_policy(uint16_t type, const void *data, size_t size) {
+  if (type == FRAME_TYPE_STATE_SET) {
+    // only the newest state is sent, but resets must not be overwritten
+    const auto *req = static_cast<const tionlt_state_set_req_t *>(data);
+    if (size == sizeof(*req) && !req->data.factory_reset && !req->data.error_reset && !req->data.filter_reset) {
+      return TX_POLICY_LATEST;
+    }
+  }
+  return TX_POLICY_FIFO;
+}
+
+tion_request_info_t TionLtApi::get_request_info(uint16_t type, const void *data, size_t size) {
+  if (type == FRAME_TYPE_STATE_REQ) {
+    return {.rsp_type = FRAME_TYPE_STATE_RSP, .request_id = 0, .idempotent = true};
+  }
+  if (type == FRAME_TYPE_STATE_SET || type == FRAME_TYPE_STATE_SAV) {
+    uint32_t request_id = 0;
+    if (size >= sizeof(request_id)) {
+      std::memcpy(&request_id, data, sizeof(request_id));
+    }
+    return {.rsp_type = FRAME_TYPE_STATE_RSP, .request_id = request_id, .idempotent = false};
+  }
+  if (type == FRAME_TYPE_DEV_INFO_REQ) {
+    return {.rsp_type = FRAME_TYPE_DEV_INFO_RSP, .request_id = 0, .idempotent = true};
+  }
+  if (type == FRAME_TYPE_AUTOKIV_PARAM_REQ) {
+    return {.rsp_type = FRAME_TYPE_AUTOKIV_PARAM_RSP, .request_id = 0, .idempotent = true};
+  }
+  if (type == FRAME_TYPE_AUTOKIV_PARAM_SET) {
+    return {.rsp_type = FRAME_TYPE_AUTOKIV_PARAM_RSP, .request_id = 0, .idempotent = false};
+  }
+  if (type == FRAME_TYPE_TEST_REQ) {
+    return {.rsp_type = FRAME_TYPE_TEST_RSP, .request_id = 0, .idempotent = true};
+  }
+  return {};
+}
+
+uint32_t TionLtApi::get_response_id(uint16_t type, const void *data, size_t size) {
+  uint32_t request_id = 0;
+  if (type == FRAME_TYPE_STATE_RSP && size >= sizeof(request_id)) {
+    std::memcpy(&request_id, data, sizeof(request_id));
+  }
+  return request_id;
+}
+
 void TionLtApi::read_frame(uint16_t frame_type, const void *frame_data, size_t frame_data_size) {
   // do not use switch statement with non-contiguous values, as this will generate a lookup table with wasted space.
   if (frame_type == FRAME_TYPE_STATE_RSP) {
@@ -3,6 +3,8 @@
 #include <functional>
 
 #include "tion-api-writer.h"
+#include "tion-api-tx-queue.h"
+#include "tion-api-request-tracker.h"
 #include "tion-api-lt-internal.h"
 #include "tion-api-defines.h"
 
@@ -11,12 +13,22 @@ namespace tion {
 
 class TionLtApi : public TionApiBase, public tion::TionApiWriter {
  public:
+  /// Features known at compile time.
+  using static_traits_type = TionLtStaticTraits;
+
   TionLtApi();
 
   void read_frame(uint16_t frame_type, const void *frame_data, size_t frame_data_size);
 
   uint16_t get_state_type() const;
 
+  /// Returns TX queue policy of the frame.
+  static tion::TionTxPolicy get_tx_policy(uint16_t type, const void *data, size_t size);
+  /// Returns response type and request id of the request frame.
+  static tion::tion_request_info_t get_request_info(uint16_t type, const void *data, size_t size);
+  /// Returns request id of the response frame.
+  static uint32_t get_response_id(uint16_t type, const void *data, size_t size);
+
   bool write_state(const TionState &state, uint32_t request_id) const;
   bool reset_filter(const TionState &state, uint32_t request_id = 1) const;
   bool factory_reset(const TionState &state, uint32_t request_id = 1) const;
@@ -26,11 +38,22 @@ class TionLtApi : public TionApiBase, public tion::TionApiWriter {
 
   void request_state() override;
   void write_state(TionStateCall *call) override {
-    this->write_state(this->make_write_state_(call), ++this->request_id_);
+    const auto state = this->make_write_state_(call);
+    if (this->write_suppressed_(state)) {
+      return;
+    }
+    const auto request_id = this->next_request_id_();
+    if (this->write_state(state, request_id)) {
+      this->state_written_(state, request_id);
+    }
   }
-  void reset_filter() override { this->reset_filter(this->state_, ++this->request_id_); }
+  void reset_filter() override { this->reset_filter(this->state_, this->next_request_id_()); }
 
  protected:
+  bool write_retry_(const TionState &state, uint32_t request_id) override {
+    return this->write_state(state, request_id);
+  }
+
   tion_lt::button_presets_t button_presets_{
       .tmp{
           TION_LT_BUTTON_PRESET_TMP1,
@@ -129,7 +129,31 @@ size_t get_rsp_frame_size(uint8_t frame_type) {
   return 0;
 }
 
+TionTxPolicy TionO2Api::get_tx_policy(uint16_t type, const void * /*data*/, size_t /*size*/) {
+  if (type == FRAME_TYPE_STATE_SET_REQ) {
+    // only the newest state is sent, device does not respond to it
+    return TX_POLICY_LATEST | TX_POLICY_NO_RESPONSE;
+  }
+  if (type == FRAME_TYPE_TIME_SET_REQ) {
+    return TX_POLICY_NO_RESPONSE;
+  }
+  return TX_POLICY_FIFO;
+}
+
+tion_request_info_t TionO2Api::get_request_info(uint16_t type, const void * /*data*/, size_t /*size*/) {
+  if (type == FRAME_TYPE_SET_WORK_MODE_REQ) {
+    return {.rsp_type = FRAME_TYPE_SET_WORK_MODE_RSP, .request_id = 0, .idempotent = false};
+  }
+  // get requests are responded with the same type in the high nibble
+  if (type == FRAME_TYPE_CONNECT_REQ || type == FRAME_TYPE_STATE_GET_REQ || type == FRAME_TYPE_DEV_MODE_REQ ||
+      type == FRAME_TYPE_TIME_GET_REQ || type == FRAME_TYPE_DEV_INFO_REQ) {
+    return {.rsp_type = static_cast<uint16_t>(type | 0x10), .request_id = 0, .idempotent = true};
+  }
+  return {};
+}
+
 void TionO2Api::read_frame(uint16_t frame_type, const void *frame_data, size_t frame_data_size) {
+  this->poll_.on_frame(frame_type);
   if (frame_type == FRAME_TYPE_STATE_GET_RSP) {
     TION_LOGD(TAG, "Response State Get");
     auto *frame = static_cast<const tiono2_state_t *>(frame_data);
@@ -207,8 +231,10 @@ bool TionO2Api::set_work_mode(WorkModeFlags work_mode) const {
 }
 
 void TionO2Api::write_state(TionStateCall *call) {
-  TION_LOGV(TAG, "Request State set");
   const auto st = this->make_write_state_(call);
+  if (this->write_suppressed_(st)) {
+    return;
+  }
 
   // auto_state невозможно получить от бризера
   this->state_.auto_state = st.auto_state;
@@ -229,19 +255,26 @@ void TionO2Api::write_state(TionStateCall *call) {
     });
   }
 
-  tiono2_state_set_t req(st);
-  TION_DUMP(TAG, "fan  : %u", req.fan_speed);
-  TION_DUMP(TAG, "temp : %u", req.target_temperature);
-  TION_DUMP(TAG, "power: %s", ONOFF(req.power_state));
-  TION_DUMP(TAG, "heat : %s", ONOFF(req.heater_state));
-  TION_DUMP(TAG, "comm : %s", req.comm_source == tion::CommSource::AUTO ? "AUTO" : "USER");
-  this->write_frame(FRAME_TYPE_STATE_SET_REQ, req);
+  if (this->write_state_(st)) {
+    this->state_written_(st, 0);
+  }
 
   if (!st.auto_state && st.sound_state) {
     this->update_work_mode();
   }
 }
 
+bool TionO2Api::write_state_(const tion::TionState &state) const {
+  TION_LOGV(TAG, "Request State set");
+  tion::TionFrameBuilder<tiono2_state_set_t> req(*this, state);
+  TION_DUMP(TAG, "fan  : %u", req->fan_speed);
+  TION_DUMP(TAG, "temp : %u", req->target_temperature);
+  TION_DUMP(TAG, "power: %s", ONOFF(req->power_state));
+  TION_DUMP(TAG, "heat : %s", ONOFF(req->heater_state));
+  TION_DUMP(TAG, "comm : %s", req->comm_source == tion::CommSource::AUTO ? "AUTO" : "USER");
+  return req.write(FRAME_TYPE_STATE_SET_REQ);
+}
+
 void TionO2Api::update_work_mode() {
   if (this->state_.auto_state) {
     this->set_work_mode({
@@ -261,12 +294,15 @@ bool TionO2Api::reset_filter(const tion::TionState &state, uint32_t request_id)
 }
 
 void TionO2Api::request_state() {
+  using request_type = tion::TionPollCycle::request_type;
+  this->poll_.begin();
   if (this->state_.firmware_version == 0) {
-    this->request_connect_();
-    this->request_dev_info_();
+    this->poll_.add(FRAME_TYPE_CONNECT_RSP, request_type::create<TionO2Api, &TionO2Api::request_connect_>(*this));
+    this->poll_.add(FRAME_TYPE_DEV_INFO_RSP, request_type::create<TionO2Api, &TionO2Api::request_dev_info_>(*this));
   }
-  this->request_dev_mode_();
-  this->request_state_();
+  this->poll_.add(FRAME_TYPE_DEV_MODE_RSP, request_type::create<TionO2Api, &TionO2Api::request_dev_mode_>(*this));
+  this->poll_.add(FRAME_TYPE_STATE_GET_RSP, request_type::create<TionO2Api, &TionO2Api::request_state_>(*this));
+  this->poll_.start();
 }
 
 TionO2Api::TionO2Api() : TionApiBase() {
@@ -3,6 +3,9 @@
 #include <functional>
 
 #include "tion-api-writer.h"
+#include "tion-api-tx-queue.h"
+#include "tion-api-request-tracker.h"
+#include "tion-api-poll.h"
 #include "tion-api-o2-internal.h"
 
 namespace dentra {
@@ -16,12 +19,20 @@ size_t get_rsp_frame_size(uint8_t frame_type);
 
 class TionO2Api : public tion::TionApiBase, public tion::TionApiWriter {
  public:
+  /// Features known at compile time.
+  using static_traits_type = tion::TionO2StaticTraits;
+
   TionO2Api();
 
   void read_frame(uint16_t frame_type, const void *frame_data, size_t frame_data_size);
 
   uint16_t get_state_type() const;
 
+  /// Returns TX queue policy of the frame.
+  static tion::TionTxPolicy get_tx_policy(uint16_t type, const void *data, size_t size);
+  /// Returns response type of the request frame.
+  static tion::tion_request_info_t get_request_info(uint16_t type, const void *data, size_t size);
+
   bool reset_filter(const tion::TionState &state, uint32_t request_id = 1) const;
   bool factory_reset(const tion::TionState &state, uint32_t request_id = 1) const;
   bool reset_errors(const tion::TionState &state, uint32_t request_id = 1) const;
@@ -29,6 +40,14 @@ class TionO2Api : public tion::TionApiBase, public tion::TionApiWriter {
   bool set_work_mode(WorkModeFlags work_mode) const;
 
   void request_state() override;
+
+  /// Sets max number of poll requests waiting for a response.
+  void set_poll_window(uint8_t window) { this->poll_.set_window(window); }
+  const tion::TionPollCycle &get_poll() const { return this->poll_; }
+  void loop() override {
+    TionApiBase::loop();
+    this->poll_.loop();
+  }
   void write_state(tion::TionStateCall *call) override;
   void reset_filter() override { this->reset_filter(this->state_); }
   /// отображение режима MA_CONNECTED и MA_AUTO на дисплее бризера.
@@ -36,10 +55,14 @@ class TionO2Api : public tion::TionApiBase, public tion::TionApiWriter {
   void update_work_mode();
 
  protected:
+  tion::TionPollCycle poll_;
+
   bool request_connect_() const;
   bool request_dev_info_() const;
   bool request_dev_mode_() const;
   bool request_state_() const;
+  bool write_state_(const tion::TionState &state) const;
+  bool write_retry_(const tion::TionState &state, uint32_t request_id) override { return this->write_state_(state); }
 
   void dump_state_(const tiono2_state_t &state) const;
   void update_state_(const tiono2_state_t &state);
@@ -0,0 +1,98 @@
+#include <cinttypes>
+
+#include "log.h"
+#include "utils.h"
+
+#include "tion-api-poll.h"
+
+namespace dentra {
+namespace tion {
+
+static const char *const TAG = "tion-api-poll";
+
+void TionPollCycle::begin() {
+  if (this->active_) {
+    TION_LOGD(TAG, "Previous poll cycle was not completed");
+    this->incomplete_++;
+  }
+  this->active_ = false;
+  this->count_ = 0;
+  this->sent_ = 0;
+  this->done_ = 0;
+}
+
+void TionPollCycle::add(uint16_t rsp_type, request_type &&request) {
+  if (this->count_ == MAX_STEPS) {
+    TION_LOGE(TAG, "Too many poll requests");
+    return;
+  }
+  auto &step = this->steps_[this->count_++];
+  step.rsp_type = rsp_type;
+  step.request = request;
+}
+
+void TionPollCycle::start() {
+  this->active_ = this->count_ > 0;
+  this->start_time_ = tion::millis();
+  this->send_();
+}
+
+bool TionPollCycle::on_frame(uint16_t type) {
+  if (!this->active_) {
+    return false;
+  }
+  for (size_t i = 0; i < this->sent_; i++) {
+    if (this->steps_[i].rsp_type == type && !(this->done_ & (1 << i))) {
+      this->complete_(i);
+      this->send_();
+      return true;
+    }
+  }
+  return false;
+}
+
+void TionPollCycle::loop() {
+  if (!this->active_) {
+    return;
+  }
+  const uint32_t now = tion::millis();
+  bool skipped = false;
+  for (size_t i = 0; i < this->sent_ && this->active_; i++) {
+    if (!(this->done_ & (1 << i)) && now - this->steps_[i].sent_time >= STEP_TIMEOUT) {
+      TION_LOGD(TAG, "Poll response 0x%04X was not received", this->steps_[i].rsp_type);
+      this->skipped_++;
+      this->complete_(i);
+      skipped = true;
+    }
+  }
+  if (skipped) {
+    this->send_();
+  }
+}
+
+void TionPollCycle::send_() {
+  while (this->active_ && this->sent_ < this->count_) {
+    const size_t in_flight = this->sent_ - __builtin_popcount(this->done_);
+    if (in_flight >= this->window_) {
+      break;
+    }
+    const size_t index = this->sent_++;
+    this->steps_[index].sent_time = tion::millis();
+    if (!this->steps_[index].request()) {
+      // failed request will never be responded
+      this->complete_(index);
+    }
+  }
+}
+
+void TionPollCycle::complete_(size_t index) {
+  this->done_ |= 1 << index;
+  if (this->done_ == (1 << this->count_) - 1) {
+    this->active_ = false;
+    this->cycle_time_ = tion::millis() - this->start_time_;
+    TION_LOGD(TAG, "Poll cycle of %u request(s) completed in %" PRIu32 " ms", this->count_, this->cycle_time_);
+  }
+}
+
+}  // namespace tion
+}  // namespace dentra
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/delegate.h>
+
+namespace dentra {
+namespace tion {
+
+/// Pipelined poll cycle. Sub-requests of a cycle are sent keeping at most window requests in flight,
+/// the next one is sent when a response to the previous one is received or its wait is timed out.
+class TionPollCycle {
+ public:
+  using request_type = etl::delegate<bool()>;
+
+  enum {
+    MAX_STEPS = 4,
+    DEFAULT_WINDOW = 2,
+    // Time to wait for a response to a sub-request, covers request tracker timeout with a resend.
+    STEP_TIMEOUT = 2000,
+  };
+
+  /// Sets max number of sub-requests waiting for a response.
+  void set_window(uint8_t window) { this->window_ = window == 0 ? 1 : window; }
+  uint8_t get_window() const { return this->window_; }
+
+  /// Starts a new cycle. Sub-requests must be added before start.
+  void begin();
+  /// Adds sub-request which is completed by a frame of rsp_type.
+  void add(uint16_t rsp_type, request_type &&request);
+  /// Sends first sub-requests of the cycle.
+  void start();
+  /// Must be called on each received frame. Returns true if the frame completes a sub-request.
+  bool on_frame(uint16_t type);
+  /// Skips sub-requests not responded in time, so a lost response does not stall the cycle.
+  void loop();
+
+  bool is_active() const { return this->active_; }
+  /// Duration of the last completed cycle in ms.
+  uint32_t get_cycle_time() const { return this->cycle_time_; }
+  /// Number of cycles restarted before completion.
+  uint32_t get_incomplete() const { return this->incomplete_; }
+  /// Number of sub-requests skipped without a response.
+  uint32_t get_skipped() const { return this->skipped_; }
+
+ protected:
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  struct step_t {
+    uint16_t rsp_type;
+    request_type request;
+    uint32_t sent_time;
+  };
+
+  step_t steps_[MAX_STEPS];
+  uint8_t window_{DEFAULT_WINDOW};
+  uint8_t count_{};
+  // number of sent sub-requests
+  uint8_t sent_{};
+  // bitmask of completed sub-requests
+  uint8_t done_{};
+  bool active_{};
+  uint32_t start_time_{};
+  uint32_t cycle_time_{};
+  uint32_t incomplete_{};
+  uint32_t skipped_{};
+
+  void send_();
+  void complete_(size_t index);
+};
+
+}  // namespace tion
+}  // namespace dentra
@@ -7,12 +7,14 @@ namespace dentra {
 namespace tion {
 
 // NOLINTNEXTLINE(readability-identifier-naming)
-template<class data_type> struct tion_frame_t {
-  uint16_t type;
+template<class data_type, class type_type = uint16_t> struct tion_frame_t {
+  type_type type;
   data_type data;
   constexpr static size_t head_size() { return sizeof(type); }
 } __attribute__((__packed__));
 using tion_any_frame_t = tion_frame_t<uint8_t[0]>;
+// frame with single byte type.
+using tion_any_frame8_t = tion_frame_t<uint8_t[0], uint8_t>;
 
 // NOLINTNEXTLINE(readability-identifier-naming)
 template<class data_type> struct tion_ble_frame_t {
@@ -37,6 +39,10 @@ template<class frame_spec_t> class TionProtocol {
   // TODO move to protected
   writer_type writer{};
   void set_writer(writer_type &&writer) { this->writer = writer; }
+
+  /// Returns frame in the protocol TX buffer to build frame data in place or nullptr if it is not supported.
+  /// write_frame does not copy data pointing to the leased frame data.
+  frame_spec_t *lease_frame(size_t data_size) { return nullptr; }
 };
 
 }  // namespace tion
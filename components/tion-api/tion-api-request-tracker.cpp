@@ -0,0 +1,153 @@
+#include <cinttypes>
+#include <cstring>
+
+#include "log.h"
+#include "utils.h"
+
+#include "tion-api-request-tracker.h"
+
+namespace dentra {
+namespace tion {
+
+static const char *const TAG = "tion-api-request-tracker";
+
+void TionRequestTracker::track(uint16_t type, const void *data, size_t size) {
+  if (!this->request_info_) {
+    return;
+  }
+  const auto info = this->request_info_(type, data, size);
+  if (info.rsp_type == 0) {
+    return;
+  }
+
+  if (this->count_ == MAX_REQUESTS) {
+    TION_LOGV(TAG, "Too many requests, 0x%04X is not tracked", type);
+    this->stats_.overflowed++;
+    return;
+  }
+
+  auto &req = this->requests_[this->count_++];
+  req.request_id = info.request_id;
+  req.sent_time = tion::millis();
+  req.type = type;
+  req.rsp_type = info.rsp_type;
+  req.retries = 0;
+  if (info.idempotent && size <= RETRY_DATA_SIZE) {
+    req.size = size;
+    std::memcpy(req.data, data, size);
+  } else {
+    req.size = NO_RETRY;
+  }
+}
+
+bool TionRequestTracker::complete(uint16_t type, const void *data, size_t size) {
+  const uint32_t response_id = this->response_id_ ? this->response_id_(type, data, size) : 0;
+  // requests are stored in order of sending, so the oldest one is found first
+  for (size_t i = 0; i < this->count_; i++) {
+    const auto &req = this->requests_[i];
+    if (req.rsp_type != type) {
+      continue;
+    }
+    if (req.request_id != 0 && response_id != 0 && req.request_id != response_id) {
+      continue;
+    }
+    const uint32_t rtt = tion::millis() - req.sent_time;
+    TION_LOGV(TAG, "Request[%" PRIu32 "] 0x%04X completed in %" PRIu32 " ms", req.request_id, req.type, rtt);
+    this->add_rtt_(type, rtt);
+    this->stats_.completed++;
+    this->lost_count_ = 0;
+    this->remove_(i);
+    return true;
+  }
+  return false;
+}
+
+void TionRequestTracker::loop() {
+  const uint32_t now = tion::millis();
+  for (size_t i = 0; i < this->count_;) {
+    auto &req = this->requests_[i];
+    if (now - req.sent_time < REQUEST_TIMEOUT) {
+      i++;
+      continue;
+    }
+
+    if (req.size != NO_RETRY && req.retries < MAX_RETRIES && this->writer_) {
+      TION_LOGD(TAG, "Request[%" PRIu32 "] 0x%04X timed out, resend", req.request_id, req.type);
+      this->stats_.retries++;
+      req.retries++;
+      req.sent_time = now;
+      this->writer_(req.type, req.data, req.size);
+      i++;
+      continue;
+    }
+
+    TION_LOGW(TAG, "Request[%" PRIu32 "] 0x%04X timed out", req.request_id, req.type);
+    this->stats_.timeouts++;
+    if (this->lost_count_ < LINK_LOST_TIMEOUTS) {
+      this->lost_count_++;
+    }
+    const uint16_t rsp_type = req.rsp_type;
+    const uint32_t request_id = req.request_id;
+    this->remove_(i);
+    this->on_timeout_.call_if(rsp_type, request_id);
+  }
+}
+
+void TionRequestTracker::remove_(size_t index) {
+  this->count_--;
+  std::memmove(&this->requests_[index], &this->requests_[index + 1], (this->count_ - index) * sizeof(request_t));
+}
+
+void TionRequestTracker::add_rtt_(uint16_t rsp_type, uint32_t rtt) {
+  rtt_t *slot = nullptr;
+  for (auto &item : this->rtt_) {
+    if (item.rsp_type == rsp_type || item.rsp_type == 0) {
+      slot = &item;
+      break;
+    }
+  }
+  if (slot == nullptr) {
+    return;
+  }
+  slot->rsp_type = rsp_type;
+
+  size_t bucket = 0;
+  while (bucket < RTT_BUCKETS - 1 && rtt >= (2u << bucket)) {
+    bucket++;
+  }
+  if (slot->buckets[bucket] == UINT16_MAX) {
+    // keep distribution while avoiding overflow
+    for (auto &value : slot->buckets) {
+      value /= 2;
+    }
+  }
+  slot->buckets[bucket]++;
+}
+
+uint32_t TionRequestTracker::get_rtt_percentile(uint16_t rsp_type, uint8_t percentile) const {
+  for (const auto &item : this->rtt_) {
+    if (item.rsp_type != rsp_type) {
+      continue;
+    }
+    uint32_t total = 0;
+    for (auto value : item.buckets) {
+      total += value;
+    }
+    if (total == 0) {
+      return 0;
+    }
+    const uint32_t rank = (total * percentile + 99) / 100;
+    uint32_t count = 0;
+    for (size_t i = 0; i < RTT_BUCKETS; i++) {
+      count += item.buckets[i];
+      if (count >= rank) {
+        return 2u << i;
+      }
+    }
+    return 2u << (RTT_BUCKETS - 1);
+  }
+  return 0;
+}
+
+}  // namespace tion
+}  // namespace dentra
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/delegate.h>
+
+// Max number of requests waiting for a response.
+#ifndef TION_REQUEST_TRACKER_SIZE
+#define TION_REQUEST_TRACKER_SIZE 8
+#endif
+
+namespace dentra {
+namespace tion {
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+struct tion_request_info_t {
+  // Response frame type, 0 if device does not respond to the request.
+  uint16_t rsp_type;
+  // Request id carried by the frame, 0 if the frame does not carry it.
+  uint32_t request_id;
+  // Request could be resent when its response is lost.
+  bool idempotent;
+};
+
+/// Correlates sent requests with received responses by response type and request id.
+/// Each request is completed or timed out individually, idempotent requests are resent once on timeout.
+class TionRequestTracker {
+ public:
+  using writer_type = etl::delegate<bool(uint16_t type, const void *data, size_t size)>;
+  using request_info_type = tion_request_info_t (*)(uint16_t type, const void *data, size_t size);
+  using response_id_type = uint32_t (*)(uint16_t type, const void *data, size_t size);
+  using on_timeout_type = etl::delegate<void(uint16_t rsp_type, uint32_t request_id)>;
+
+  enum {
+    MAX_REQUESTS = TION_REQUEST_TRACKER_SIZE,
+    // Max number of response types with RTT statistics.
+    MAX_RTT_TYPES = 8,
+    // Number of RTT histogram buckets, bucket N > 0 holds RTT in [2^N, 2^(N+1)) ms.
+    RTT_BUCKETS = 12,
+    // Max data size of a request that could be resent.
+    RETRY_DATA_SIZE = 8,
+    // Time to wait for a response.
+    REQUEST_TIMEOUT = 1000,
+    // Number of resends of a timed out idempotent request.
+    MAX_RETRIES = 1,
+    // Number of requests timed out in a row to treat the link as lost.
+    LINK_LOST_TIMEOUTS = 3,
+  };
+
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  struct stats_t {
+    // Number of requests completed by a response.
+    uint32_t completed;
+    // Number of resent requests.
+    uint32_t retries;
+    // Number of requests timed out after all retries.
+    uint32_t timeouts;
+    // Number of requests not tracked due to full table.
+    uint32_t overflowed;
+  };
+
+  /// Sets writer used to resend requests.
+  void set_writer(writer_type &&writer) { this->writer_ = writer; }
+  /// Without request info no request is tracked.
+  void set_request_info(request_info_type request_info) { this->request_info_ = request_info; }
+  /// Without response id responses are matched by type only.
+  void set_response_id(response_id_type response_id) { this->response_id_ = response_id; }
+  /// Sets callback called for each request timed out after all retries.
+  void set_on_timeout(on_timeout_type &&on_timeout) { this->on_timeout_ = on_timeout; }
+
+  /// Starts tracking of a sent request frame.
+  void track(uint16_t type, const void *data, size_t size);
+  /// Completes the oldest request matching the received frame. Returns false for unsolicited frames.
+  bool complete(uint16_t type, const void *data, size_t size);
+  /// Resends or times out expired requests.
+  void loop();
+
+  /// Number of requests waiting for a response.
+  size_t size() const { return this->count_; }
+  const stats_t &get_stats() const { return this->stats_; }
+  /// Link does not respond at all, as opposite to a slow link with growing RTT.
+  bool is_link_lost() const { return this->lost_count_ >= LINK_LOST_TIMEOUTS; }
+  /// Returns upper bound of RTT percentile in ms for the response type, or 0 when there is no data.
+  uint32_t get_rtt_percentile(uint16_t rsp_type, uint8_t percentile) const;
+
+ protected:
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  struct request_t {
+    uint32_t request_id;
+    // time of the last (re)send.
+    uint32_t sent_time;
+    uint16_t type;
+    uint16_t rsp_type;
+    uint8_t retries;
+    // size of the data to resend or 0xFF if request could not be resent.
+    uint8_t size;
+    uint8_t data[RETRY_DATA_SIZE];
+  };
+
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  struct rtt_t {
+    uint16_t rsp_type;
+    uint16_t buckets[RTT_BUCKETS];
+  };
+
+  enum : uint8_t { NO_RETRY = 0xFF };
+
+  writer_type writer_{};
+  request_info_type request_info_{};
+  response_id_type response_id_{};
+  on_timeout_type on_timeout_{};
+  request_t requests_[MAX_REQUESTS];
+  uint8_t count_{};
+  uint8_t lost_count_{};
+  stats_t stats_{};
+  rtt_t rtt_[MAX_RTT_TYPES]{};
+
+  void remove_(size_t index);
+  void add_rtt_(uint16_t rsp_type, uint32_t rtt);
+};
+
+}  // namespace tion
+}  // namespace dentra
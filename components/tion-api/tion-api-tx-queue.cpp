@@ -0,0 +1,130 @@
+#include <cstring>
+
+#include "log.h"
+#include "utils.h"
+
+#include "tion-api-tx-queue.h"
+
+namespace dentra {
+namespace tion {
+
+static const char *const TAG = "tion-api-tx-queue";
+
+bool TionTxQueue::write(uint16_t type, const void *data, size_t size) {
+  if (!this->writer_) {
+    TION_LOGE(TAG, "Writer is not configured");
+    return false;
+  }
+
+  TionTxPolicy policy = this->policy_ ? this->policy_(type, data, size) : TX_POLICY_BYPASS;
+  if (this->half_duplex_) {
+    policy = static_cast<TionTxPolicy>(policy & ~TX_POLICY_BYPASS);
+  }
+  if (policy & TX_POLICY_BYPASS) {
+    return this->send_(type, data, size, policy | TX_POLICY_NO_RESPONSE);
+  }
+
+  this->loop();
+  if (this->pending_ < this->get_window() && this->count_ == 0) {
+    return this->send_(type, data, size, policy);
+  }
+
+  if (size > DATA_MAX_SIZE) {
+    TION_LOGE(TAG, "Frame 0x%04X is too large to be queued: %zu", type, size);
+    this->tx_stats_.rejected++;
+    return false;
+  }
+
+  return this->enqueue_(type, data, size, policy);
+}
+
+void TionTxQueue::on_frame() {
+  if (this->pending_ > 0) {
+    this->pending_--;
+  }
+  this->send_next_();
+}
+
+void TionTxQueue::loop() {
+  if (this->pending_ && tion::millis() - this->pending_time_ >= RESPONSE_TIMEOUT) {
+    TION_LOGV(TAG, "Response timeout");
+    this->tx_stats_.timeouts++;
+    // responses to earlier frames are not expected after the last one is timed out
+    this->pending_ = 0;
+  }
+  this->send_next_();
+}
+
+bool TionTxQueue::send_(uint16_t type, const void *data, size_t size, TionTxPolicy policy) {
+  this->tx_stats_.sent++;
+  if (!(policy & TX_POLICY_NO_RESPONSE)) {
+    this->pending_++;
+    this->pending_time_ = tion::millis();
+  }
+  return this->writer_(type, data, size);
+}
+
+void TionTxQueue::send_next_() {
+  while (this->pending_ < this->get_window() && this->count_ > 0) {
+    // the head entry is moved out before sending, so a frame written by the writer is queued after the rest
+    const entry_t entry = this->queue_[0];
+    this->count_--;
+    std::memmove(&this->queue_[0], &this->queue_[1], this->count_ * sizeof(entry_t));
+    this->send_(entry.type, entry.data, entry.size, entry.policy);
+  }
+}
+
+bool TionTxQueue::enqueue_(uint16_t type, const void *data, size_t size, TionTxPolicy policy) {
+  // only a frame of the same type queued last is checked, so the last written frame of the type is always sent
+  for (size_t i = this->count_; i-- > 0;) {
+    auto &entry = this->queue_[i];
+    if (entry.type != type) {
+      continue;
+    }
+    if ((policy & TX_POLICY_LATEST) && (entry.policy & TX_POLICY_LATEST)) {
+      TION_LOGV(TAG, "Coalesce frame 0x%04X", type);
+      this->tx_stats_.coalesced++;
+      entry.size = size;
+      std::memcpy(entry.data, data, size);
+      return true;
+    }
+    if (entry.size == size && std::memcmp(entry.data, data, size) == 0) {
+      TION_LOGV(TAG, "Dedupe frame 0x%04X", type);
+      this->tx_stats_.deduped++;
+      return true;
+    }
+    break;
+  }
+
+  if (this->count_ == QUEUE_SIZE) {
+    TION_LOGW(TAG, "Queue is full, frame 0x%04X dropped", type);
+    this->tx_stats_.overflowed++;
+    return false;
+  }
+
+  size_t pos = this->count_;
+  if (policy & TX_POLICY_PRIORITY) {
+    // after already queued priority frames
+    pos = 0;
+    while (pos < this->count_ && (this->queue_[pos].policy & TX_POLICY_PRIORITY)) {
+      pos++;
+    }
+    std::memmove(&this->queue_[pos + 1], &this->queue_[pos], (this->count_ - pos) * sizeof(entry_t));
+  }
+
+  auto &entry = this->queue_[pos];
+  entry.type = type;
+  entry.policy = policy;
+  entry.size = size;
+  std::memcpy(entry.data, data, size);
+  this->count_++;
+  if (this->count_ > this->tx_stats_.max_queued) {
+    this->tx_stats_.max_queued = this->count_;
+  }
+  TION_LOGV(TAG, "Queued frame 0x%04X, size %u", type, this->count_);
+
+  return true;
+}
+
+}  // namespace tion
+}  // namespace dentra
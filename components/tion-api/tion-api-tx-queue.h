@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/delegate.h>
+
+// Max number of frames waiting for transmission.
+#ifndef TION_TX_QUEUE_SIZE
+#define TION_TX_QUEUE_SIZE 4
+#endif
+
+// Max size of frame data that could be queued, larger frames are sent only when nothing is pending.
+#ifndef TION_TX_QUEUE_DATA_SIZE
+#define TION_TX_QUEUE_DATA_SIZE 24
+#endif
+
+namespace dentra {
+namespace tion {
+
+/// Transmission policy flags of a frame.
+enum TionTxPolicy : uint8_t {
+  /// Sent in order, identical frame queued last of the type is dropped.
+  TX_POLICY_FIFO = 0,
+  /// Latest wins, replaces a frame of the same type queued last.
+  TX_POLICY_LATEST = 1 << 0,
+  /// Sent ahead of regular frames.
+  TX_POLICY_PRIORITY = 1 << 1,
+  /// Device does not respond to the frame, so the next frame is not delayed.
+  TX_POLICY_NO_RESPONSE = 1 << 2,
+  /// Sent immediately bypassing the queue.
+  TX_POLICY_BYPASS = 1 << 3,
+};
+
+constexpr TionTxPolicy operator|(TionTxPolicy a, TionTxPolicy b) {
+  return static_cast<TionTxPolicy>(static_cast<uint8_t>(a) | static_cast<uint8_t>(b));
+}
+
+/// Bounded TX queue with per frame type policy. Up to window frames wait for a response at a time (one by default),
+/// frames written meanwhile are queued, coalesced and sent when a response is received or timed out.
+class TionTxQueue {
+ public:
+  using writer_type = etl::delegate<bool(uint16_t type, const void *data, size_t size)>;
+  using policy_type = TionTxPolicy (*)(uint16_t type, const void *data, size_t size);
+
+  enum {
+    QUEUE_SIZE = TION_TX_QUEUE_SIZE,
+    DATA_MAX_SIZE = TION_TX_QUEUE_DATA_SIZE,
+    // Time to wait for a response before the next frame is sent.
+    RESPONSE_TIMEOUT = 500,
+  };
+
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  struct tx_stats_t {
+    // Number of sent frames.
+    uint32_t sent;
+    // Number of frames replaced by a newer frame of the same type.
+    uint32_t coalesced;
+    // Number of frames dropped as identical to already queued.
+    uint32_t deduped;
+    // Number of frames dropped due to full queue.
+    uint32_t overflowed;
+    // Number of frames dropped as too large to be queued.
+    uint32_t rejected;
+    // Number of times responses were not received in RESPONSE_TIMEOUT.
+    uint32_t timeouts;
+    // Max number of frames queued at once.
+    uint32_t max_queued;
+  };
+
+  void set_writer(writer_type &&writer) { this->writer_ = writer; }
+  /// Without a policy all frames bypass the queue.
+  void set_policy(policy_type policy) { this->policy_ = policy; }
+  /// In half-duplex mode every frame waits for a response, bypass policy and window are ignored.
+  void set_half_duplex(bool half_duplex) { this->half_duplex_ = half_duplex; }
+  /// Sets max number of sent frames waiting for a response at once.
+  void set_window(uint8_t window) { this->window_ = window == 0 ? 1 : window; }
+  uint8_t get_window() const { return this->half_duplex_ ? 1 : this->window_; }
+
+  /// Sends a frame or queues it when window of responses is pending.
+  bool write(uint16_t type, const void *data, size_t size);
+  /// Must be called on each received frame. Releases a pending response and sends the next queued frame.
+  void on_frame();
+  /// Sends the next queued frames when pending responses are timed out.
+  void loop();
+
+  /// Number of queued frames.
+  size_t size() const { return this->count_; }
+  bool is_pending() const { return this->pending_ != 0; }
+  /// Number of sent frames waiting for a response.
+  size_t get_pending() const { return this->pending_; }
+  const tx_stats_t &get_tx_stats() const { return this->tx_stats_; }
+
+ protected:
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  struct entry_t {
+    uint16_t type;
+    TionTxPolicy policy;
+    uint8_t size;
+    uint8_t data[DATA_MAX_SIZE];
+  };
+
+  writer_type writer_{};
+  policy_type policy_{};
+  entry_t queue_[QUEUE_SIZE];
+  uint8_t count_{};
+  uint8_t window_{1};
+  // number of sent frames waiting for a response
+  uint8_t pending_{};
+  bool half_duplex_{};
+  // time of the last sent frame waiting for a response
+  uint32_t pending_time_{};
+  tx_stats_t tx_stats_{};
+
+  bool send_(uint16_t type, const void *data, size_t size, TionTxPolicy policy);
+  bool enqueue_(uint16_t type, const void *data, size_t size, TionTxPolicy policy);
+  void send_next_();
+};
+
+}  // namespace tion
+}  // namespace dentra
@@ -1,6 +1,7 @@
 #include <utility>
 #include <cstring>
 #include <cstdlib>
+#include <cstddef>
 
 #include "crc.h"
 #include "utils.h"
@@ -22,83 +23,14 @@ struct Tion4sRawUartFrame {
 };
 #pragma pack(pop)
 
-void Tion4sUartProtocol::read_uart_data(TionUartReader *io) {
-  if (!this->reader) {
-    TION_LOGE(TAG, "Reader is not configured");
-    return;
-  }
+// must match Tion4sUartProtocol framer layout
+static_assert(offsetof(Tion4sRawUartFrame, data) == 3, "Invalid frame view offset");
 
-  while (io->available() > 0) {
-    if (this->read_frame_(io) == READ_NEXT_LOOP) {
-      break;
-    }
-    tion::yield();
+Tion4sUartProtocol::frame_spec_type *Tion4sUartProtocol::lease_frame(size_t data_size) {
+  if (sizeof(Tion4sRawUartFrame) + data_size > FRAME_MAX_SIZE) {
+    return nullptr;
   }
-}
-
-Tion4sUartProtocol::read_frame_result_t Tion4sUartProtocol::read_frame_(TionUartReader *io) {
-  auto *frame = reinterpret_cast<Tion4sRawUartFrame *>(this->buf_);
-  if (frame->magic != Tion4sRawUartFrame::FRAME_MAGIC) {
-    if (io->available() < sizeof(frame->magic)) {
-      // do not flood log while waiting magic
-      // TION_LOGV(TAG, "Waiting frame magic");
-      return READ_NEXT_LOOP;
-    }
-    if (!io->read_array(&frame->magic, sizeof(frame->magic))) {
-      TION_LOGW(TAG, "Failed read frame magic");
-      return READ_THIS_LOOP;
-    }
-    if (frame->magic != Tion4sRawUartFrame::FRAME_MAGIC) {
-      TION_LOGW(TAG, "Unxepected byte: 0x%02X", frame->magic);
-      return READ_THIS_LOOP;
-    }
-  }
-
-  if (frame->size == 0) {
-    constexpr size_t frame_size_size = sizeof(frame->size);
-    if (io->available() < frame_size_size) {
-      TION_LOGV(TAG, "Waiting frame size %i of %zu", io->available(), frame_size_size);
-      return READ_NEXT_LOOP;
-    }
-    if (!io->read_array(&frame->size, frame_size_size)) {
-      TION_LOGW(TAG, "Failed read frame size");
-      this->reset_buf_();
-      return READ_THIS_LOOP;
-    }
-  }
-
-  if (frame->size < sizeof(Tion4sRawUartFrame) || frame->size > FRAME_MAX_SIZE) {
-    TION_LOGW(TAG, "Invalid frame size %u", frame->size);
-    this->reset_buf_();
-    return READ_THIS_LOOP;
-  }
-
-  auto tail_size = frame->size - sizeof(frame->size) - sizeof(frame->magic);
-  if (io->available() < tail_size) {
-    TION_LOGV(TAG, "Waiting frame data %i of %zu", io->available(), tail_size);
-    return READ_NEXT_LOOP;
-  }
-  if (!io->read_array(&frame->data.type, tail_size)) {
-    TION_LOGW(TAG, "Failed read frame data");
-    this->reset_buf_();
-    return READ_THIS_LOOP;
-  }
-
-  TION_LOGV(TAG, "RX: %s", hex_cstr(frame, frame->size));
-
-  auto crc = dentra::tion::crc16_ccitt_false_ffff(frame, frame->size);
-  if (crc != 0) {
-    TION_LOGW(TAG, "Invalid CRC %04X for frame %s", crc, hex_cstr(frame, frame->size));
-    this->reset_buf_();
-    return READ_NEXT_LOOP;
-  }
-
-  tion::yield();
-  auto frame_data_size = frame->size - sizeof(Tion4sRawUartFrame) + sizeof(tion_any_frame_t);
-  this->reader(*reinterpret_cast<const tion_any_frame_t *>(&frame->data), frame_data_size);
-  this->reset_buf_();
-
-  return READ_NEXT_LOOP;
+  return reinterpret_cast<frame_spec_type *>(&reinterpret_cast<Tion4sRawUartFrame *>(this->tx_buf_)->data);
 }
 
 bool Tion4sUartProtocol::write_frame(uint16_t type, const void *data, size_t size) {
@@ -113,19 +45,21 @@ bool Tion4sUartProtocol::write_frame(uint16_t type, const void *data, size_t siz
     return false;
   }
 
-  uint8_t frame_buf[FRAME_MAX_SIZE];
-  auto *frame = reinterpret_cast<Tion4sRawUartFrame *>(frame_buf);
+  auto *frame = reinterpret_cast<Tion4sRawUartFrame *>(this->tx_buf_);
   frame->magic = Tion4sRawUartFrame::FRAME_MAGIC;
   frame->size = frame_size;
   frame->data.type = type;
 
-  std::memcpy(frame->data.data, data, size);
+  // data is already in place when it was built in the leased frame
+  if (data != frame->data.data) {
+    std::memcpy(frame->data.data, data, size);
+  }
   uint16_t crc = __builtin_bswap16(crc16_ccitt_false_ffff(frame, frame_size - sizeof(crc)));
   std::memcpy(&frame->data.data[size], &crc, sizeof(crc));
 
-  TION_LOGV(TAG, "TX: %s", tion::hex_cstr(frame_buf, frame_size));
+  TION_LOGV(TAG, "TX: %s", tion::hex_cstr(this->tx_buf_, frame_size));
 
-  return this->writer(frame_buf, frame_size);
+  return this->writer(this->tx_buf_, frame_size);
 }
 
 }  // namespace tion
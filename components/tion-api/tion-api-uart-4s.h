@@ -5,15 +5,12 @@
 namespace dentra {
 namespace tion {
 
-class Tion4sUartProtocol : public TionUartProtocolBase<0x2A> {
+// frame: magic(0x3A) size(uint16) type(uint16) data crc16
+class Tion4sUartProtocol
+    : public TionUartFramer<0x2A, TionUartHeadMagic<0x3A, 3>, TionUartLengthExplicit<1>, TionUartCheckCrc16> {
  public:
-  void read_uart_data(TionUartReader *io);
-
+  frame_spec_type *lease_frame(size_t data_size);
   bool write_frame(uint16_t type, const void *data, size_t size);
-
- protected:
-  /// Reads a frame starting with size for hw uart or continue reading for sw uart
-  read_frame_result_t read_frame_(TionUartReader *io);
 };
 
 }  // namespace tion
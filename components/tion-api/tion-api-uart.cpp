@@ -0,0 +1,50 @@
+#include "log.h"
+#include "utils.h"
+
+#include "tion-api-uart.h"
+
+namespace dentra {
+namespace tion {
+
+static const char *const TAG = "tion-api-uart";
+
+void TionUartFramerBase::log_no_reader_() { TION_LOGE(TAG, "Reader is not configured"); }
+
+bool TionUartFramerBase::read_array_(TionUartReader *io, uint8_t *data, size_t size) {
+  if (!io->read_array(data, size)) {
+    TION_LOGW(TAG, "Failed read %zu bytes", size);
+    return false;
+  }
+  return true;
+}
+
+void TionUartFramerBase::on_dropped_(size_t size, uint8_t byte) {
+  TION_LOGW(TAG, "Dropped %zu byte(s) starting with 0x%02X", size, byte);
+  this->rx_stats_.dropped += size;
+  this->resync_dropped_ += size;
+}
+
+void TionUartFramerBase::on_invalid_size_(size_t size, uint8_t byte) {
+  TION_LOGW(TAG, "Invalid frame size %zu at 0x%02X", size, byte);
+}
+
+void TionUartFramerBase::on_invalid_check_(uint32_t check, const uint8_t *frame, size_t size) {
+  TION_LOGW(TAG, "Invalid CRC %04" PRIX32 " for frame %s", check, hex_cstr(frame, size));
+  this->rx_stats_.crc_errors++;
+}
+
+void TionUartFramerBase::on_frame_(const uint8_t *frame, size_t size) {
+  TION_LOGV(TAG, "RX: %s", hex_cstr(frame, size));
+  if (this->resync_dropped_ > 0) {
+    this->rx_stats_.resyncs++;
+    this->rx_stats_.last_dropped = this->resync_dropped_;
+    if (this->resync_dropped_ > this->rx_stats_.max_dropped) {
+      this->rx_stats_.max_dropped = this->resync_dropped_;
+    }
+    this->resync_dropped_ = 0;
+  }
+  this->rx_stats_.frames++;
+}
+
+}  // namespace tion
+}  // namespace dentra
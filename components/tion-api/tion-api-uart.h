@@ -1,7 +1,8 @@
 #pragma once
 
-#include <cstring>  // std::memset
-
+#include "crc.h"
+#include "utils.h"
+#include "ring_buffer.h"
 #include "tion-api-protocol.h"
 
 namespace dentra {
@@ -13,7 +14,8 @@ class TionUartReader {
   virtual bool read_array(void *data, size_t size) = 0;
 };
 
-template<size_t frame_max_size_value> class TionUartProtocolBase : public TionProtocol<tion_any_frame_t> {
+template<size_t frame_max_size_value, class frame_spec_t = tion_any_frame_t>
+class TionUartProtocolBase : public TionProtocol<frame_spec_t> {
  protected:
   enum { FRAME_MAX_SIZE = frame_max_size_value };
   // NOLINTNEXTLINE(readability-identifier-naming)
@@ -22,9 +24,253 @@ template<size_t frame_max_size_value> class TionUartProtocolBase : public TionPr
     READ_NEXT_LOOP = 0,
     // stay read frame in current loop
     READ_THIS_LOOP = 1,
+    // drop all received data
+    READ_FLUSH = 2,
   };
   uint8_t buf_[FRAME_MAX_SIZE]{};
-  void reset_buf_() { std::memset(this->buf_, 0, sizeof(this->buf_)); }
+  // frame being written, frame data may be built in place with lease_frame.
+  uint8_t tx_buf_[FRAME_MAX_SIZE]{};
+};
+
+// Header layout policies. Find a frame start in received data and define where frame_spec starts in the frame.
+// FLUSH_ON_ERROR drops all received data on an invalid frame instead of resync from the next byte.
+
+/// Frame starts with a magic byte known at compile time.
+template<uint8_t magic_value, size_t view_offset_value = 0> struct TionUartHeadMagic {
+  enum { VIEW_OFFSET = view_offset_value, FLUSH_ON_ERROR = false };
+  template<class buf_t> size_t find(const buf_t &buf) const { return buf.find(magic_value); }
+};
+
+/// Frame starts with a magic byte known at run time.
+struct TionUartHeadMagicVar {
+  enum { VIEW_OFFSET = 0, FLUSH_ON_ERROR = false };
+  uint8_t magic{};
+  template<class buf_t> size_t find(const buf_t &buf) const { return buf.find(this->magic); }
+};
+
+/// Frame may start at any byte, so a byte inside a broken frame could be taken as a frame start.
+/// The next frame is expected at the start of the next received data.
+struct TionUartHeadAny {
+  enum { VIEW_OFFSET = 0, FLUSH_ON_ERROR = true };
+  template<class buf_t> size_t find(const buf_t & /*buf*/) const { return 0; }
+};
+
+// Length source policies. HEAD_SIZE is number of bytes required to get the frame size, 0 is invalid frame size.
+
+/// Frame size is stored in little-endian uint16 at offset.
+template<size_t offset> struct TionUartLengthExplicit {
+  enum { HEAD_SIZE = offset + sizeof(uint16_t) };
+  template<class buf_t> size_t get(const buf_t &buf) const { return buf[offset] | (buf[offset + 1] << 8); }
+};
+
+/// Frame size is fixed.
+template<size_t size> struct TionUartLengthFixed {
+  enum { HEAD_SIZE = 1 };
+  template<class buf_t> size_t get(const buf_t & /*buf*/) const { return size; }
+};
+
+/// Frame size is looked up by the first (type) byte. lookup returns size of the rest of the frame or 0.
+struct TionUartLengthLookup {
+  enum { HEAD_SIZE = 1 };
+  size_t (*lookup)(uint8_t type){};
+  template<class buf_t> size_t get(const buf_t &buf) const {
+    const size_t size = this->lookup(buf[0]);
+    return size == 0 ? 0 : size + 1;
+  }
+};
+
+// Checksum policies. TAIL_SIZE is number of bytes after frame_spec data, check returns 0 for a valid frame.
+
+/// CRC-16/CCITT-FALSE in big-endian at the tail.
+struct TionUartCheckCrc16 {
+  enum { TAIL_SIZE = sizeof(uint16_t) };
+  uint32_t check(const uint8_t *frame, size_t size) const { return crc16_ccitt_false_ffff(frame, size); }
+};
+
+/// XOR of all bytes with 0xFF initial value at the tail.
+struct TionUartCheckXor8 {
+  enum { TAIL_SIZE = sizeof(uint8_t) };
+  uint32_t check(const uint8_t *frame, size_t size) const {
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < size; i++) {
+      crc ^= frame[i];
+    }
+    return crc;
+  }
+};
+
+/// No checksum, frame ends with a magic byte.
+template<uint8_t magic_value> struct TionUartCheckNone {
+  enum { TAIL_SIZE = sizeof(uint8_t) };
+  uint32_t check(const uint8_t *frame, size_t size) const { return frame[size - 1] ^ magic_value; }
+};
+
+/// Non template part of TionUartFramer.
+class TionUartFramerBase {
+ public:
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  struct rx_stats_t {
+    // Number of successfully received frames.
+    uint32_t frames;
+    // Number of frames dropped due to invalid checksum.
+    uint32_t crc_errors;
+    // Number of completed resyncs.
+    uint32_t resyncs;
+    // Total number of bytes dropped while resyncing.
+    uint32_t dropped;
+    // Number of bytes dropped by the last completed resync.
+    uint16_t last_dropped;
+    // Max number of bytes dropped by a single resync.
+    uint16_t max_dropped;
+  };
+
+  const rx_stats_t &get_rx_stats() const { return this->rx_stats_; }
+
+ protected:
+  rx_stats_t rx_stats_{};
+  // bytes dropped by the current resync.
+  uint16_t resync_dropped_{};
+
+  static void log_no_reader_();
+  static bool read_array_(TionUartReader *io, uint8_t *data, size_t size);
+  void on_dropped_(size_t size, uint8_t byte);
+  void on_invalid_size_(size_t size, uint8_t byte);
+  void on_invalid_check_(uint32_t check, const uint8_t *frame, size_t size);
+  void on_frame_(const uint8_t *frame, size_t size);
+};
+
+/// Zero-copy UART framer. Received data is read in bulk into a ring buffer and
+/// the reader gets frame_spec pointing directly into it. Only a frame wrapped around
+/// the end of the ring buffer is copied to buf_.
+template<size_t frame_max_size_value, class head_t, class length_t, class check_t,
+         class frame_spec_t = tion_any_frame_t>
+class TionUartFramer : public TionUartProtocolBase<frame_max_size_value, frame_spec_t>, public TionUartFramerBase {
+  using base_t = TionUartProtocolBase<frame_max_size_value, frame_spec_t>;
+  using read_frame_result_t = typename base_t::read_frame_result_t;
+
+ public:
+  void read_uart_data(TionUartReader *io) {
+    if (!this->reader) {
+      log_no_reader_();
+      return;
+    }
+    bool flush = false;
+    while (this->read_rx_buf_(io)) {
+      // the rest of the broken data is being received
+      if (flush) {
+        this->resync_();
+        continue;
+      }
+      read_frame_result_t res;
+      while ((res = this->read_frame_()) == base_t::READ_THIS_LOOP) {
+        tion::yield();
+      }
+      flush = res == base_t::READ_FLUSH;
+    }
+  }
+
+ protected:
+  // must hold at least two max frames.
+  constexpr static size_t RX_BUF_SIZE = ring_buffer_capacity(frame_max_size_value * 2);
+  constexpr static size_t FRAME_MIN_SIZE = head_t::VIEW_OFFSET + frame_spec_t::head_size() + check_t::TAIL_SIZE;
+  static_assert(static_cast<size_t>(length_t::HEAD_SIZE) <= FRAME_MIN_SIZE, "Frame head is larger than min frame");
+
+  head_t head_{};
+  length_t length_{};
+  check_t check_{};
+  RingBuffer<RX_BUF_SIZE> rx_buf_;
+
+  /// Reads all available data into rx buffer. Returns false if nothing was read.
+  bool read_rx_buf_(TionUartReader *io) {
+    const int available = io->available();
+    if (available <= 0) {
+      return false;
+    }
+    size_t left = available;
+    // at most two reads when free space wraps around the end of the buffer
+    while (left > 0) {
+      size_t size;
+      auto *ptr = this->rx_buf_.write_ptr(&size);
+      if (size == 0) {
+        break;
+      }
+      if (size > left) {
+        size = left;
+      }
+      if (!read_array_(io, ptr, size)) {
+        break;
+      }
+      this->rx_buf_.commit(size);
+      left -= size;
+    }
+    return left < static_cast<size_t>(available);
+  }
+
+  /// Drops size bytes from rx buffer head.
+  void drop_(size_t size) {
+    if (size > 0) {
+      this->on_dropped_(size, this->rx_buf_[0]);
+      this->rx_buf_.skip(size);
+    }
+  }
+
+  read_frame_result_t resync_() {
+    if (head_t::FLUSH_ON_ERROR) {
+      this->drop_(this->rx_buf_.size());
+      this->rx_buf_.clear();
+      return base_t::READ_FLUSH;
+    }
+    // resync from the next byte already received
+    this->drop_(1);
+    return base_t::READ_THIS_LOOP;
+  }
+
+  /// Reads a frame from rx buffer.
+  read_frame_result_t read_frame_() {
+    const size_t rx_size = this->rx_buf_.size();
+    if (rx_size == 0) {
+      return base_t::READ_NEXT_LOOP;
+    }
+
+    const size_t pos = this->head_.find(this->rx_buf_);
+    if (pos > 0) {
+      this->drop_(pos);
+      return pos < rx_size ? base_t::READ_THIS_LOOP : base_t::READ_NEXT_LOOP;
+    }
+
+    if (rx_size < length_t::HEAD_SIZE) {
+      return base_t::READ_NEXT_LOOP;
+    }
+
+    const size_t frame_size = this->length_.get(this->rx_buf_);
+    if (frame_size < FRAME_MIN_SIZE || frame_size > base_t::FRAME_MAX_SIZE) {
+      this->on_invalid_size_(frame_size, this->rx_buf_[0]);
+      return this->resync_();
+    }
+
+    if (rx_size < frame_size) {
+      return base_t::READ_NEXT_LOOP;
+    }
+
+    const uint8_t *frame = this->rx_buf_.linearize(frame_size, this->buf_);
+    const uint32_t check = this->check_.check(frame, frame_size);
+    if (check != 0) {
+      this->on_invalid_check_(check, frame, frame_size);
+      return this->resync_();
+    }
+
+    this->on_frame_(frame, frame_size);
+    tion::yield();
+    this->reader(*reinterpret_cast<const frame_spec_t *>(frame + head_t::VIEW_OFFSET),
+                 frame_size - head_t::VIEW_OFFSET - check_t::TAIL_SIZE);
+    this->rx_buf_.skip(frame_size);
+    if (this->rx_buf_.empty()) {
+      // next frame will start at the buffer start, so it will not wrap.
+      this->rx_buf_.clear();
+    }
+
+    return base_t::READ_THIS_LOOP;
+  }
 };
 
 }  // namespace tion
@@ -3,6 +3,9 @@
 #pragma once
 
 #include <cinttypes>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <etl/delegate.h>
 
 namespace dentra {
@@ -13,6 +16,13 @@ class TionApiWriter {
   using writer_type = etl::delegate<bool(uint16_t type, const void *data, size_t size)>;
   void set_writer(writer_type &&writer) { this->writer_ = writer; }
 
+  using lease_type = etl::delegate<void *(size_t size)>;
+  void set_lease(lease_type &&lease) { this->lease_ = lease; }
+
+  /// Returns storage for size bytes of frame data in the transport TX buffer or nullptr if it is not supported.
+  /// Data written there is sent by write_frame without copying until the next write.
+  void *lease_frame(size_t size) const { return this->lease_ ? this->lease_(size) : nullptr; }
+
   // Write any frame data.
   bool write_frame(uint16_t type, const void *data, size_t size) const;
   /// Write a frame with empty data.
@@ -25,6 +35,32 @@ class TionApiWriter {
 
  protected:
   writer_type writer_{};
+  lease_type lease_{};
+};
+
+/// Frame data built in place in the transport TX buffer, or on stack when the transport does not support it.
+template<class T> class TionFrameBuilder {
+  static_assert(alignof(T) == 1, "T must be packed");
+
+ public:
+  TionFrameBuilder(const TionFrameBuilder &) = delete;             // non construction-copyable
+  TionFrameBuilder &operator=(const TionFrameBuilder &) = delete;  // non copyable
+
+  template<class... Args>
+  explicit TionFrameBuilder(const TionApiWriter &writer, Args &&...args) : writer_(writer) {
+    void *data = writer.lease_frame(sizeof(T));
+    this->data_ = new (data ? data : this->local_) T{std::forward<Args>(args)...};
+  }
+
+  T *operator->() { return this->data_; }
+  T &operator*() { return *this->data_; }
+
+  bool write(uint16_t type) const { return this->writer_.write_frame(type, this->data_, sizeof(T)); }
+
+ protected:
+  const TionApiWriter &writer_;
+  T *data_;
+  uint8_t local_[sizeof(T)];
 };
 
 }  // namespace tion
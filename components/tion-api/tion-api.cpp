@@ -65,10 +65,10 @@ void TionState::dump(const char *TAG, const TionTraits &traits) const {
   TION_DUMP(TAG, "current_temp: %d °C", this->current_temperature);
   TION_DUMP(TAG, "gate_pos    : %s", this->get_gate_position_str(traits));
 
-  if (traits.supports_sound_state) {
+  if (traits.supports<FEATURE_SOUND_STATE>()) {
     TION_DUMP(TAG, "sound       : %s", ONOFF(this->sound_state));
   }
-  if (traits.supports_led_state) {
+  if (traits.supports<FEATURE_LED_STATE>()) {
     TION_DUMP(TAG, "led         : %s", ONOFF(this->led_state));
   }
 
@@ -79,27 +79,27 @@ void TionState::dump(const char *TAG, const TionTraits &traits) const {
     TION_DUMP(TAG, "heater_max  : %u W", traits.get_max_heater_power());
   }
 
-  if (traits.supports_heater_var) {
+  if (traits.supports<FEATURE_HEATER_VAR>()) {
     TION_DUMP(TAG, "heater_var  : %u %%", this->heater_var);
   }
 
   TION_DUMP(TAG, "productivity: %u m³", this->productivity);
 
   TION_DUMP(TAG, "filter_time : %" PRIu32 " s", this->filter_time_left);
-  if (traits.supports_work_time) {
+  if (traits.supports<FEATURE_WORK_TIME>()) {
     TION_DUMP(TAG, "work_time   : %" PRIu32 " s", this->work_time);
   }
-  if (traits.supports_fan_time) {
+  if (traits.supports<FEATURE_FAN_TIME>()) {
     TION_DUMP(TAG, "fan_time    : %" PRIu32 " s", this->fan_time);
   }
-  if (traits.supports_airflow_counter) {
+  if (traits.supports<FEATURE_AIRFLOW_COUNTER>()) {
     TION_DUMP(TAG, "airflow     : %.3f m³ (%" PRIu32 ")", this->airflow_m3, this->airflow_counter);
   }
 
-  if (traits.supports_pcb_pwr_temperature) {
+  if (traits.supports<FEATURE_PCB_PWR_TEMPERATURE>()) {
     TION_DUMP(TAG, "pcb_pwr_temp: %d °C", this->pcb_pwr_temperature);
   }
-  if (traits.supports_pcb_ctl_temperatire) {
+  if (traits.supports<FEATURE_PCB_CTL_TEMPERATURE>()) {
     TION_DUMP(TAG, "pcb_ctl_temp: %d °C", this->pcb_ctl_temperature);
   }
 
@@ -113,15 +113,76 @@ void TionState::dump(const char *TAG, const TionTraits &traits) const {
   TION_DUMP(TAG, "errors      : 0x%08" PRIX32, this->errors);
 }
 
+uint32_t TionState::get_changes(const TionState &other) const {
+  uint32_t changes = 0;
+  auto check = [&changes](bool changed, TionStateField field) {
+    if (changed) {
+      changes |= field;
+    }
+  };
+  check(this->power_state != other.power_state, STATE_FIELD_POWER);
+  check(this->heater_state != other.heater_state, STATE_FIELD_HEATER);
+  check(this->sound_state != other.sound_state, STATE_FIELD_SOUND);
+  check(this->led_state != other.led_state, STATE_FIELD_LED);
+  check(this->auto_state != other.auto_state, STATE_FIELD_AUTO);
+  check(this->filter_state != other.filter_state, STATE_FIELD_FILTER);
+  check(this->gate_error_state != other.gate_error_state, STATE_FIELD_GATE_ERROR);
+  check(this->fan_speed != other.fan_speed, STATE_FIELD_FAN_SPEED);
+  check(this->gate_position != other.gate_position, STATE_FIELD_GATE_POSITION);
+  check(this->outdoor_temperature != other.outdoor_temperature, STATE_FIELD_OUTDOOR_TEMPERATURE);
+  check(this->current_temperature != other.current_temperature, STATE_FIELD_CURRENT_TEMPERATURE);
+  check(this->target_temperature != other.target_temperature, STATE_FIELD_TARGET_TEMPERATURE);
+  check(this->productivity != other.productivity, STATE_FIELD_PRODUCTIVITY);
+  check(this->heater_var != other.heater_var, STATE_FIELD_HEATER_VAR);
+  check(this->work_time != other.work_time, STATE_FIELD_WORK_TIME);
+  check(this->fan_time != other.fan_time, STATE_FIELD_FAN_TIME);
+  check(this->filter_time_left != other.filter_time_left, STATE_FIELD_FILTER_TIME);
+  check(this->airflow_counter != other.airflow_counter || this->airflow_m3 != other.airflow_m3, STATE_FIELD_AIRFLOW);
+  check(this->boost_time_left != other.boost_time_left, STATE_FIELD_BOOST_TIME);
+  check(this->firmware_version != other.firmware_version || this->hardware_version != other.hardware_version,
+        STATE_FIELD_VERSION);
+  check(this->pcb_ctl_temperature != other.pcb_ctl_temperature, STATE_FIELD_PCB_CTL_TEMPERATURE);
+  check(this->pcb_pwr_temperature != other.pcb_pwr_temperature, STATE_FIELD_PCB_PWR_TEMPERATURE);
+  check(this->errors != other.errors, STATE_FIELD_ERRORS);
+  return changes;
+}
+
+void TionState::copy_fields(const TionState &other, uint32_t fields) {
+  if (fields & STATE_FIELD_POWER) {
+    this->power_state = other.power_state;
+  }
+  if (fields & STATE_FIELD_HEATER) {
+    this->heater_state = other.heater_state;
+  }
+  if (fields & STATE_FIELD_SOUND) {
+    this->sound_state = other.sound_state;
+  }
+  if (fields & STATE_FIELD_LED) {
+    this->led_state = other.led_state;
+  }
+  if (fields & STATE_FIELD_AUTO) {
+    this->auto_state = other.auto_state;
+  }
+  if (fields & STATE_FIELD_FAN_SPEED) {
+    this->fan_speed = other.fan_speed;
+  }
+  if (fields & STATE_FIELD_GATE_POSITION) {
+    this->gate_position = other.gate_position;
+  }
+  if (fields & STATE_FIELD_TARGET_TEMPERATURE) {
+    this->target_temperature = other.target_temperature;
+  }
+}
+
 float TionState::get_heater_power(const TionTraits &traits) const {
-  if (traits.supports_heater_var) {
+  if (traits.supports<FEATURE_HEATER_VAR>()) {
     return (traits.max_heater_power * this->heater_var) * 0.1f;
   }
   return this->is_heating(traits) ? traits.get_max_heater_power() : 0.0f;
 }
 
 bool TionState::is_heating(const TionTraits &traits) const {
-  if (traits.supports_heater_var) {
+  if (traits.supports<FEATURE_HEATER_VAR>()) {
     return this->heater_var > 0;
   }
   if (!this->heater_state || traits.max_heater_power == 0) {
@@ -135,10 +196,10 @@ bool TionState::is_heating(const TionTraits &traits) const {
 }
 
 const char *TionState::get_gate_position_str(const TionTraits &traits) const {
-  if (traits.supports_gate_error && this->gate_error_state) {
+  if (traits.supports<FEATURE_GATE_ERROR>() && this->gate_error_state) {
     return "error";
   }
-  if (traits.supports_gate_position_change_mixed) {
+  if (traits.supports<FEATURE_GATE_POSITION_CHANGE_MIXED>()) {
     switch (this->gate_position) {
       case TionGatePosition::OUTDOOR:
         return "outdoor";
@@ -150,7 +211,7 @@ const char *TionState::get_gate_position_str(const TionTraits &traits) const {
         return "unknown";
     }
 
-  } else if (traits.supports_gate_position_change) {
+  } else if (traits.supports<FEATURE_GATE_POSITION_CHANGE>()) {
     switch (this->gate_position) {
       case TionGatePosition::OUTDOOR:
         return "inflow";
@@ -235,7 +296,7 @@ TionState TionApiBase::make_write_state_(TionStateCall *call) const {
     }
   }
 
-  if (this->traits_.supports_sound_state) {
+  if (this->traits_.supports<FEATURE_SOUND_STATE>()) {
     if (call->get_sound_state().has_value()) {
       const auto sound_state = *call->get_sound_state();
       if (cs.sound_state != sound_state) {
@@ -245,7 +306,7 @@ TionState TionApiBase::make_write_state_(TionStateCall *call) const {
     }
   }
 
-  if (this->traits_.supports_led_state) {
+  if (this->traits_.supports<FEATURE_LED_STATE>()) {
     if (call->get_led_state().has_value()) {
       const auto led_state = *call->get_led_state();
       if (cs.led_state != led_state) {
@@ -255,7 +316,7 @@ TionState TionApiBase::make_write_state_(TionStateCall *call) const {
     }
   }
 
-  if (this->traits_.supports_gate_position_change) {
+  if (this->traits_.supports<FEATURE_GATE_POSITION_CHANGE>()) {
     if (call->get_gate_position().has_value()) {
       auto gate_position = *call->get_gate_position();
       switch (gate_position) {
@@ -270,7 +331,7 @@ TionState TionApiBase::make_write_state_(TionStateCall *call) const {
           break;
         }
         case TionGatePosition::MIXED: {
-          if (!this->traits_.supports_gate_position_change_mixed) {
+          if (!this->traits_.supports<FEATURE_GATE_POSITION_CHANGE_MIXED>()) {
             gate_position = cs.gate_position;
           }
           break;
@@ -287,7 +348,7 @@ TionState TionApiBase::make_write_state_(TionStateCall *call) const {
     }
   }
 
-  if (this->traits_.supports_manual_antifrize) {
+  if (this->traits_.supports<FEATURE_MANUAL_ANTIFRIZE>()) {
     if (ns.power_state && !ns.heater_state && ns.outdoor_temperature < 0) {
       TION_LOGW(TAG, "Antifrize protection has worked. Heater now enabled.");
       ns.heater_state = true;
@@ -361,10 +422,20 @@ void TionStateCall::reset() {
 
 TionApiBase::TionApiBase() : auto_pi_(TION_AUTO_KP, TION_AUTO_TI, TION_AUTO_DB) {
   this->traits_.boost_time = TION_BOOST_TIME;
+  this->auto_output_.set_hysteresis(TION_AUTO_HYSTERESIS);
+  this->auto_output_.set_min_dwell(TION_AUTO_MIN_DWELL);
+  this->auto_output_.set_rate_limit(TION_AUTO_RATE_LIMIT_BURST, TION_AUTO_RATE_LIMIT_INTERVAL);
+  this->auto_input_.set_smoothing(TION_AUTO_SMOOTHING);
+  this->auto_input_.set_timeout(TION_AUTO_SENSOR_TIMEOUT);
 }
 
 void TionApiBase::notify_state_(uint32_t request_id) {
-  TionStateCall *call = nullptr;
+  this->notifying_ = true;
+  this->verify_check_(request_id);
+  this->optimistic_reconcile_(request_id);
+
+  // internal changes are collected in a stack call, so state processing does not allocate
+  TionStateCall call(this);
 
   if (this->state_.boost_time_left > 0) {
     // если изменили скорость вентиляции или выключили бризер
@@ -372,28 +443,22 @@ void TionApiBase::notify_state_(uint32_t request_id) {
       TION_LOGD(TAG, "Boost canceled by user action");
       // пересохраняем изменившиеся данные, для восстановления
       this->boost_save_state_();
-      if (call == nullptr) {
-        call = new TionStateCall(this);
-      }
-      this->boost_cancel_(call);
+      this->boost_cancel_(&call);
     } else {
       // только если натив буст не поддерживается
-      if (!this->traits_.supports_boost) {
+      if (!this->traits_.supports<FEATURE_BOOST>()) {
         const auto boost_work_time = this->state_.work_time - this->boost_save_.start_time;
         if (boost_work_time < this->traits_.boost_time) {
           this->state_.boost_time_left = this->traits_.boost_time - boost_work_time;
         } else {
-          if (call == nullptr) {
-            call = new TionStateCall(this);
-          }
-          this->boost_cancel_(call);
+          this->boost_cancel_(&call);
         }
       }
       TION_DUMP(TAG, "Boost time left %d s", this->state_.boost_time_left);
     }
   }
 
-  if (this->active_preset_ != PRESET_NONE) {
+  if (this->active_preset_ != PRESET_NONE_ID) {
     auto is_preset_modified = [](const PresetData &pr, const TionState &st) -> bool {
       if (pr.power_state >= 0 && pr.power_state != st.power_state) {
         return true;
@@ -415,28 +480,205 @@ void TionApiBase::notify_state_(uint32_t request_id) {
       }
       return false;
     };
-    if (is_preset_modified(this->presets_[this->active_preset_], this->state_)) {
-      this->active_preset_ = PRESET_NONE;
+    if (is_preset_modified(this->presets_[this->active_preset_].data, this->state_)) {
+      this->active_preset_ = PRESET_NONE_ID;
+      this->preset_changed_ = true;
     }
   }
 
-  if (this->traits_.supports_manual_antifrize) {
+  if (this->traits_.supports<FEATURE_MANUAL_ANTIFRIZE>()) {
     const auto &cs = this->state_;
     if (cs.power_state && !cs.heater_state && cs.outdoor_temperature < 0) {
       TION_LOGW(TAG, "Antifrize protection has worked. Heater now enabled.");
-      if (call == nullptr) {
-        call = new TionStateCall(this);
-      }
-      call->set_heater_state(true);
+      call.set_heater_state(true);
     }
   }
 
-  if (call) {
-    call->perform();
-    delete call;
+  if (call.has_changes()) {
+    call.perform();
+  }
+  this->notifying_ = false;
+
+  uint32_t changes = this->has_notified_state_ ? this->state_.get_changes(this->notified_state_) : STATE_FIELD_ALL;
+  if (this->preset_changed_) {
+    this->preset_changed_ = false;
+    changes |= STATE_FIELD_PRESET;
+  }
+  this->notified_state_ = this->state_;
+  this->has_notified_state_ = true;
+#ifdef TION_ENABLE_HISTORY
+  this->history_.push(this->state_);
+#endif
+
+  this->on_state_fn.call_if(this->state_, changes, request_id);
+}
+
+bool TionApiBase::write_suppressed_(const TionState &state) {
+  // nothing to compare with until the first state is received
+  if (!this->state_.initialized) {
+    return false;
+  }
+  // the same state is already written and waits for verification
+  const auto &current = this->verify_.fields != 0 ? this->verify_.target : this->state_;
+  if (state.get_changes(current) & STATE_FIELD_WRITABLE) {
+    return false;
+  }
+  TION_LOGD(TAG, "State write suppressed, nothing changed");
+  this->write_stats_.suppressed++;
+  return true;
+}
+
+void TionApiBase::state_written_(const TionState &state, uint32_t request_id) {
+  this->verify_start_(state, request_id);
+  this->optimistic_apply_(state, request_id);
+}
+
+void TionApiBase::verify_start_(const TionState &state, uint32_t request_id) {
+  const uint32_t fields = state.get_changes(this->state_) & STATE_FIELD_WRITABLE;
+  if (fields == 0 || !this->state_.initialized) {
+    return;
   }
+  // a new write replaces the previous one
+  this->verify_.fields = fields;
+  this->verify_.request_id = request_id;
+  this->verify_.responses = 0;
+  this->verify_.retries = 0;
+  this->verify_.time = tion::millis();
+  this->verify_.target = state;
+}
 
-  this->on_state_fn.call_if(this->state_, request_id);
+void TionApiBase::verify_check_(uint32_t request_id) {
+  if (this->verify_.fields == 0) {
+    return;
+  }
+  const uint32_t mismatch = this->verify_.fields & this->state_.get_changes(this->verify_.target);
+  if (mismatch == 0) {
+    TION_LOGV(TAG, "State write verified");
+    this->verify_.fields = 0;
+    return;
+  }
+  if (this->verify_.responses < UINT8_MAX) {
+    this->verify_.responses++;
+  }
+  // the first response may be requested before the write, but the next one is requested after it,
+  // so a lost response to the write does not hold verification
+  const bool is_response = (this->verify_.request_id != 0 && this->verify_.request_id == request_id) ||
+                           this->verify_.responses > 1;
+  if (!is_response) {
+    return;
+  }
+  if (this->verify_.retries >= WRITE_MAX_RETRIES) {
+    TION_LOGW(TAG, "State write was not applied: 0x%08" PRIX32, mismatch);
+    this->write_stats_.verify_failed++;
+    this->verify_.fields = 0;
+    return;
+  }
+  // keep fields changed by the breezer since the write, rewrite only written ones
+  auto state = this->state_;
+  state.copy_fields(this->verify_.target, this->verify_.fields);
+  const uint32_t retry_id = this->verify_.request_id != 0 ? this->next_request_id_() : 0;
+  if (!this->write_retry_(state, retry_id)) {
+    TION_LOGW(TAG, "State write was not applied: 0x%08" PRIX32, mismatch);
+    this->write_stats_.verify_failed++;
+    this->verify_.fields = 0;
+    return;
+  }
+  this->verify_.retries++;
+  this->write_stats_.retries++;
+  TION_LOGW(TAG, "State write was not applied: 0x%08" PRIX32 ", retry %u", mismatch, this->verify_.retries);
+  this->verify_.request_id = retry_id;
+  this->verify_.responses = 0;
+  this->verify_.time = tion::millis();
+  this->verify_.target = state;
+  // pending fields wait for the retry response
+  if (this->pending_.fields != 0) {
+    this->pending_.request_id = retry_id;
+    this->pending_.time = tion::millis();
+  }
+}
+
+void TionApiBase::verify_expire_() {
+  if (this->verify_.fields == 0 || tion::millis() - this->verify_.time < WRITE_VERIFY_TIMEOUT) {
+    return;
+  }
+  TION_LOGW(TAG, "State write was not verified: 0x%08" PRIX32, this->verify_.fields);
+  this->write_stats_.verify_failed++;
+  this->verify_.fields = 0;
+}
+
+void TionApiBase::optimistic_apply_(const TionState &state, uint32_t request_id) {
+  // nothing to compare with until the first state is received
+  if (!this->optimistic_ || !this->has_notified_state_) {
+    return;
+  }
+  const uint32_t fields = state.get_changes(this->state_) & STATE_FIELD_WRITABLE;
+  if (fields == 0) {
+    return;
+  }
+  if (this->pending_.fields == 0) {
+    this->pending_.device = this->state_;
+  }
+  this->pending_.fields |= fields;
+  this->pending_.request_id = request_id;
+  this->pending_.time = tion::millis();
+  this->pending_.responses = 0;
+  this->pending_.target = state;
+  this->state_.copy_fields(state, fields);
+  TION_LOGD(TAG, "Pending fields: 0x%08" PRIX32, this->pending_.fields);
+  // received state is notified with pending fields later
+  if (!this->notifying_) {
+    this->optimistic_notify_();
+  }
+}
+
+void TionApiBase::optimistic_reconcile_(uint32_t request_id) {
+  if (this->pending_.fields == 0) {
+    return;
+  }
+  this->pending_.device = this->state_;
+  this->pending_.fields &= this->state_.get_changes(this->pending_.target);
+  if (this->pending_.fields == 0) {
+    TION_LOGD(TAG, "Pending fields confirmed");
+    return;
+  }
+  if (this->pending_.responses < UINT8_MAX) {
+    this->pending_.responses++;
+  }
+  // without request id responses are ordered, but the first one may be requested before the write
+  const bool is_response = this->pending_.request_id != 0 ? this->pending_.request_id == request_id
+                                                          : this->pending_.responses > 1;
+  // the write is still retried
+  if (is_response && this->verify_.fields == 0) {
+    TION_LOGW(TAG, "Breezer refused fields: 0x%08" PRIX32, this->pending_.fields);
+    this->pending_.fields = 0;
+    return;
+  }
+  // outdated state, keep pending values
+  this->state_.copy_fields(this->pending_.target, this->pending_.fields);
+}
+
+void TionApiBase::optimistic_check_() {
+  if (this->pending_.fields == 0 || tion::millis() - this->pending_.time < this->optimistic_timeout_) {
+    return;
+  }
+  TION_LOGW(TAG, "Fields were not confirmed: 0x%08" PRIX32, this->pending_.fields);
+  this->state_.copy_fields(this->pending_.device, this->pending_.fields);
+  this->pending_.fields = 0;
+  // rolled back write is not retried anymore
+  if (this->verify_.fields != 0) {
+    this->verify_.fields = 0;
+    this->write_stats_.verify_failed++;
+  }
+  this->optimistic_notify_();
+}
+
+void TionApiBase::optimistic_notify_() {
+  const uint32_t changes = this->state_.get_changes(this->notified_state_);
+  if (changes == 0) {
+    return;
+  }
+  this->notified_state_ = this->state_;
+  this->on_state_fn.call_if(this->state_, changes, OPTIMISTIC_REQUEST_ID);
 }
 
 void TionApiBase::set_boost_time(uint16_t boost_time) {
@@ -477,7 +719,7 @@ void TionApiBase::enable_boost(bool state, TionStateCall *call) {
   }
 
   TION_LOGD(TAG, "Switching boost to %s", ONOFF(state));
-  if (this->traits_.supports_boost) {
+  if (this->traits_.supports<FEATURE_BOOST>()) {
     this->boost_enable_native_(state);
     return;
   }
@@ -581,33 +823,56 @@ void TionApiBase::preset_enable_(const PresetData &preset, TionStateCall *call)
 }
 
 void TionApiBase::enable_preset(const std::string &preset, TionStateCall *call) {
-  TION_LOGD(TAG, "Activate preset '%s'", preset.c_str());
   if (preset.empty() || strcasecmp(preset.c_str(), PRESET_NONE) == 0) {
-    this->active_preset_ = preset;
+    this->enable_preset(PRESET_NONE_ID, call);
     return;
   }
-  const auto &it = this->presets_.find(preset);
-  if (it == this->presets_.end()) {
+  const auto preset_id = this->find_preset(preset);
+  if (preset_id == PRESET_NONE_ID) {
     TION_LOGD(TAG, "Preset '%s' not found", preset.c_str());
     return;
   }
-  this->active_preset_ = preset;
-  this->preset_enable_(it->second, call);
+  this->enable_preset(preset_id, call);
+}
+
+void TionApiBase::enable_preset(uint8_t preset_id, TionStateCall *call) {
+  if (preset_id > this->presets_count_) {
+    TION_LOGW(TAG, "Invalid preset id %u", preset_id);
+    return;
+  }
+  TION_LOGD(TAG, "Activate preset '%s'", this->presets_[preset_id].name.c_str());
+  this->active_preset_ = preset_id;
+  this->preset_changed_ = true;
+  if (preset_id != PRESET_NONE_ID) {
+    this->preset_enable_(this->presets_[preset_id].data, call);
+  }
+}
+
+uint8_t TionApiBase::find_preset(const std::string &name) const {
+  for (uint8_t id = 1; id <= this->presets_count_; id++) {
+    if (this->presets_[id].name == name) {
+      return id;
+    }
+  }
+  return PRESET_NONE_ID;
+}
+
+const std::string &TionApiBase::get_preset_name(uint8_t preset_id) const {
+  return this->presets_[preset_id <= this->presets_count_ ? preset_id : PRESET_NONE_ID].name;
 }
 
 std::set<std::string> TionApiBase::get_presets() const {
   std::set<std::string> presets;
-  presets.emplace(PRESET_NONE);
-  for (auto &&preset : this->presets_) {
-    presets.emplace(preset.first);
+  for (uint8_t id = 0; id <= this->presets_count_; id++) {
+    presets.emplace(this->presets_[id].name);
   }
   return presets;
 };
 
 TionApiBase::PresetData TionApiBase::get_preset(const std::string &name) const {
-  const auto &it = this->presets_.find(name);
-  if (it != this->presets_.end()) {
-    return it->second;
+  const auto preset_id = this->find_preset(name);
+  if (preset_id != PRESET_NONE_ID) {
+    return this->presets_[preset_id].data;
   }
   return {};
 }
@@ -637,7 +902,16 @@ void TionApiBase::add_preset(const std::string &name, const PresetData &data) {
   }
   TION_LOGD(TAG, "Setup preset '%s': power=%d, heat=%d, fan=%u, temp=%d, gate=%u", name.c_str(), data.power_state,
             data.heater_state, data.fan_speed, data.target_temperature, static_cast<uint8_t>(data.gate_position));
-  this->presets_.insert_or_assign(name, data);
+  auto preset_id = this->find_preset(name);
+  if (preset_id == PRESET_NONE_ID) {
+    if (this->presets_count_ == MAX_PRESETS) {
+      TION_LOGW(TAG, "Too many presets, '%s' skipped", name.c_str());
+      return;
+    }
+    preset_id = ++this->presets_count_;
+    this->presets_[preset_id].name = name;
+  }
+  this->presets_[preset_id].data = data;
 }
 
 void TionApiBase::set_auto_pi_data(float kp, float ti, int db) {
@@ -684,7 +958,7 @@ void TionApiBase::set_auto_max_fan_speed(uint8_t max_fan_speed) {
 void TionApiBase::auto_update_fan_speed_() {
   this->auto_pi_.set_min(this->traits_.auto_prod[this->auto_min_fan_speed_]);
   this->auto_pi_.set_max(this->traits_.auto_prod[this->auto_max_fan_speed_]);
-  this->on_state_fn.call_if(this->state_, 0);
+  this->on_state_fn.call_if(this->state_, STATE_FIELD_AUTO_SETTINGS, LOCAL_REQUEST_ID);
 }
 
 bool TionApiBase::auto_update(uint16_t current, TionStateCall *call) {
@@ -725,6 +999,10 @@ bool TionApiBase::auto_update(uint16_t current, TionStateCall *call) {
   if (this->state_.boost_time_left > 0) {
     return false;
   }
+  // returning into the range changed by the user is not limited
+  if (this->auto_fan_speed_in_range_() && !this->auto_output_.allow()) {
+    return false;
+  }
   TION_LOGV(TAG, "Auto new fan speed %u", fan_speed);
   // для понимания, что переключение было из авто-режима, всегда вытавляем авто
   call->set_auto_state(true);
@@ -732,9 +1010,27 @@ bool TionApiBase::auto_update(uint16_t current, TionStateCall *call) {
   return true;
 }
 
+bool TionApiBase::auto_update(auto_co2::AutoSensor sensor, float value, TionStateCall *call) {
+  this->auto_input_.update(sensor, value);
+  const uint16_t demand = this->auto_input_.demand(this->auto_setpoint_);
+  // zero resets PI controller, but no data is not a reason for that
+  if (demand == 0) {
+    return false;
+  }
+  return this->auto_update(demand, call);
+}
+
 uint8_t TionApiBase::auto_pi_update_(uint16_t current) {
-  int rate = this->auto_pi_.update(this->auto_setpoint_, current);
+  const int rate = static_cast<int>(this->auto_pi_.update(this->auto_setpoint_, current));
   TION_LOGV(TAG, "Auto PI rate: %d", rate);
+  const uint8_t fan_speed = this->auto_rate_to_fan_speed_(rate);
+  if (!this->auto_fan_speed_in_range_()) {
+    return fan_speed;
+  }
+  return this->auto_output_.hold(rate, fan_speed, this->state_.fan_speed, this->traits_.auto_prod);
+}
+
+uint8_t TionApiBase::auto_rate_to_fan_speed_(int rate) const {
   if (rate > 0) {
     // приводим m^3/h в скорость вентиляции
     for (auto i = this->traits_.max_fan_speed; i > 0; i--) {
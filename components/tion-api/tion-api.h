@@ -1,7 +1,6 @@
 #pragma once
 
 #include <cstddef>
-#include <map>
 #include <set>
 #include <vector>
 #include <type_traits>
@@ -11,12 +10,84 @@
 #include "tion-api-defines.h"
 #include "utils.h"
 #include "pi_controller.h"
+#include "auto_output.h"
+#include "auto_input.h"
+#ifdef TION_ENABLE_HISTORY
+#include "tion-api-history.h"
+#endif
 
 namespace dentra {
 namespace tion {
 
 enum class CommSource : uint8_t { AUTO = 0, USER = 1 };
 
+/// TionTraits supports_* features as a bitmask.
+enum TionFeature : uint32_t {
+  FEATURE_LED_STATE = 1 << 0,
+  FEATURE_SOUND_STATE = 1 << 1,
+  FEATURE_GATE_POSITION_CHANGE = 1 << 2,
+  FEATURE_GATE_POSITION_CHANGE_MIXED = 1 << 3,
+  FEATURE_HEATER_VAR = 1 << 4,
+  FEATURE_WORK_TIME = 1 << 5,
+  FEATURE_FAN_TIME = 1 << 6,
+  FEATURE_AIRFLOW_COUNTER = 1 << 7,
+  FEATURE_GATE_ERROR = 1 << 8,
+  FEATURE_PCB_CTL_TEMPERATURE = 1 << 9,
+  FEATURE_PCB_PWR_TEMPERATURE = 1 << 10,
+  FEATURE_MANUAL_ANTIFRIZE = 1 << 11,
+  FEATURE_BOOST = 1 << 12,
+  FEATURE_RESET_FILTER = 1 << 13,
+  FEATURE_ALL = (1 << 14) - 1,
+};
+
+/// Features known at compile time.
+/// @tparam supported_value features which can be supported, others are always unsupported.
+/// @tparam dynamic_value supported features which are still checked at runtime.
+template<uint32_t supported_value, uint32_t dynamic_value = 0> struct TionStaticTraits {
+  static constexpr uint32_t SUPPORTED = supported_value;
+  static constexpr uint32_t DYNAMIC = dynamic_value & supported_value;
+};
+
+// Features are defined at runtime, default for builds with several models.
+using TionDynamicTraits = TionStaticTraits<FEATURE_ALL, FEATURE_ALL>;
+
+// Manual antifrize depends on TION_ENABLE_ANTIFRIZE.
+using Tion3sStaticTraits = TionStaticTraits<FEATURE_SOUND_STATE | FEATURE_GATE_POSITION_CHANGE |
+                                                FEATURE_GATE_POSITION_CHANGE_MIXED | FEATURE_MANUAL_ANTIFRIZE |
+                                                FEATURE_RESET_FILTER,
+                                            FEATURE_MANUAL_ANTIFRIZE>;
+// Native boost depends on firmware version.
+using Tion4sStaticTraits =
+    TionStaticTraits<FEATURE_LED_STATE | FEATURE_SOUND_STATE | FEATURE_GATE_POSITION_CHANGE | FEATURE_HEATER_VAR |
+                         FEATURE_WORK_TIME | FEATURE_FAN_TIME | FEATURE_AIRFLOW_COUNTER | FEATURE_GATE_ERROR |
+                         FEATURE_PCB_CTL_TEMPERATURE | FEATURE_PCB_PWR_TEMPERATURE | FEATURE_BOOST |
+                         FEATURE_RESET_FILTER,
+                     FEATURE_BOOST>;
+using TionLtStaticTraits =
+    TionStaticTraits<FEATURE_LED_STATE | FEATURE_SOUND_STATE | FEATURE_HEATER_VAR | FEATURE_WORK_TIME |
+                     FEATURE_FAN_TIME | FEATURE_AIRFLOW_COUNTER | FEATURE_PCB_PWR_TEMPERATURE | FEATURE_RESET_FILTER>;
+// Manual antifrize depends on TION_ENABLE_ANTIFRIZE.
+using TionO2StaticTraits = TionStaticTraits<FEATURE_SOUND_STATE | FEATURE_WORK_TIME | FEATURE_GATE_ERROR |
+                                                FEATURE_MANUAL_ANTIFRIZE,
+                                            FEATURE_MANUAL_ANTIFRIZE>;
+
+/// Combines traits of several models, features which differ between models are checked at runtime.
+template<class... traits> struct TionMergedTraits;
+template<class traits> struct TionMergedTraits<traits> : traits {};
+template<class first, class... rest> struct TionMergedTraits<first, rest...> {
+  using other = TionMergedTraits<rest...>;
+  static constexpr uint32_t SUPPORTED = first::SUPPORTED | other::SUPPORTED;
+  static constexpr uint32_t DYNAMIC = first::DYNAMIC | other::DYNAMIC | (first::SUPPORTED ^ other::SUPPORTED);
+};
+
+// Traits of the build. TION_STATIC_TRAITS is a list of used model static traits, e.g. Tion4sStaticTraits.
+// TION_DYNAMIC_TRAITS forces runtime checks when there are apis without model traits.
+#if defined(TION_STATIC_TRAITS) && !defined(TION_DYNAMIC_TRAITS)
+using TionBuildTraits = TionMergedTraits<TION_STATIC_TRAITS>;
+#else
+using TionBuildTraits = TionDynamicTraits;
+#endif
+
 struct TionTraits {
   struct {
     bool supports_led_state : 1;
@@ -72,6 +143,54 @@ struct TionTraits {
 
   /// Массив производительностей бризера для каждой скорости, включая 0.
   const uint8_t *auto_prod;
+
+  /// Checks feature support. Features unsupported by the build are false at compile time
+  /// and static ones are true without runtime check, so guarded code is dropped by compiler.
+  template<uint32_t feature> bool supports() const {
+    if constexpr ((TionBuildTraits::SUPPORTED & feature) == 0) {
+      return false;
+    } else if constexpr ((TionBuildTraits::DYNAMIC & feature) == 0) {
+      return true;
+    } else {
+      return this->has_feature(static_cast<TionFeature>(feature));
+    }
+  }
+
+  /// Checks runtime feature support.
+  bool has_feature(TionFeature feature) const {
+    switch (feature) {
+      case FEATURE_LED_STATE:
+        return this->supports_led_state;
+      case FEATURE_SOUND_STATE:
+        return this->supports_sound_state;
+      case FEATURE_GATE_POSITION_CHANGE:
+        return this->supports_gate_position_change;
+      case FEATURE_GATE_POSITION_CHANGE_MIXED:
+        return this->supports_gate_position_change_mixed;
+      case FEATURE_HEATER_VAR:
+        return this->supports_heater_var;
+      case FEATURE_WORK_TIME:
+        return this->supports_work_time;
+      case FEATURE_FAN_TIME:
+        return this->supports_fan_time;
+      case FEATURE_AIRFLOW_COUNTER:
+        return this->supports_airflow_counter;
+      case FEATURE_GATE_ERROR:
+        return this->supports_gate_error;
+      case FEATURE_PCB_CTL_TEMPERATURE:
+        return this->supports_pcb_ctl_temperatire;
+      case FEATURE_PCB_PWR_TEMPERATURE:
+        return this->supports_pcb_pwr_temperature;
+      case FEATURE_MANUAL_ANTIFRIZE:
+        return this->supports_manual_antifrize;
+      case FEATURE_BOOST:
+        return this->supports_boost;
+      case FEATURE_RESET_FILTER:
+        return this->supports_reset_filter;
+      default:
+        return false;
+    }
+  }
 };
 
 enum class TionGatePosition : uint8_t {
@@ -84,6 +203,46 @@ enum class TionGatePosition : uint8_t {
   NONE = UNKNOWN,
 };
 
+/// TionState fields, used as a bitmask of fields changed by a state update.
+enum TionStateField : uint32_t {
+  STATE_FIELD_POWER = 1 << 0,
+  STATE_FIELD_HEATER = 1 << 1,
+  STATE_FIELD_SOUND = 1 << 2,
+  STATE_FIELD_LED = 1 << 3,
+  STATE_FIELD_AUTO = 1 << 4,
+  STATE_FIELD_FILTER = 1 << 5,
+  STATE_FIELD_GATE_ERROR = 1 << 6,
+  STATE_FIELD_FAN_SPEED = 1 << 7,
+  STATE_FIELD_GATE_POSITION = 1 << 8,
+  STATE_FIELD_OUTDOOR_TEMPERATURE = 1 << 9,
+  STATE_FIELD_CURRENT_TEMPERATURE = 1 << 10,
+  STATE_FIELD_TARGET_TEMPERATURE = 1 << 11,
+  STATE_FIELD_PRODUCTIVITY = 1 << 12,
+  STATE_FIELD_HEATER_VAR = 1 << 13,
+  STATE_FIELD_WORK_TIME = 1 << 14,
+  STATE_FIELD_FAN_TIME = 1 << 15,
+  STATE_FIELD_FILTER_TIME = 1 << 16,
+  // airflow_counter and airflow_m3
+  STATE_FIELD_AIRFLOW = 1 << 17,
+  STATE_FIELD_BOOST_TIME = 1 << 18,
+  // firmware_version and hardware_version
+  STATE_FIELD_VERSION = 1 << 19,
+  STATE_FIELD_PCB_CTL_TEMPERATURE = 1 << 20,
+  STATE_FIELD_PCB_PWR_TEMPERATURE = 1 << 21,
+  STATE_FIELD_ERRORS = 1 << 22,
+  // not a state field: active preset is changed
+  STATE_FIELD_PRESET = 1 << 23,
+  // not a state field: auto mode settings are changed
+  STATE_FIELD_AUTO_SETTINGS = 1 << 24,
+  // constantly changing counters
+  STATE_FIELD_COUNTERS = STATE_FIELD_WORK_TIME | STATE_FIELD_FAN_TIME | STATE_FIELD_FILTER_TIME | STATE_FIELD_AIRFLOW,
+  // fields changed by TionStateCall
+  STATE_FIELD_WRITABLE = STATE_FIELD_POWER | STATE_FIELD_HEATER | STATE_FIELD_SOUND | STATE_FIELD_LED |
+                         STATE_FIELD_AUTO | STATE_FIELD_FAN_SPEED | STATE_FIELD_GATE_POSITION |
+                         STATE_FIELD_TARGET_TEMPERATURE,
+  STATE_FIELD_ALL = UINT32_MAX,
+};
+
 class TionState {
  public:
   struct {
@@ -165,6 +324,11 @@ class TionState {
   // Потребляет ли сейчас обогреватель энергию.
   bool is_heating(const TionTraits &traits) const;
 
+  /// Returns bitmask of TionStateField which values differ from the other state.
+  uint32_t get_changes(const TionState &other) const;
+  /// Copies values of STATE_FIELD_WRITABLE fields selected by bitmask from the other state.
+  void copy_fields(const TionState &other, uint32_t fields);
+
   // backward compatibility methods
   bool is_initialized() const { return this->initialized || this->fan_speed > 0; }
   const char *get_gate_position_str(const TionTraits &traits) const;
@@ -224,7 +388,8 @@ std::string decode_errors(uint32_t errors, uint8_t error_min_bit, uint8_t error_
 
 class TionApiBase {
   /// Callback listener for response to request_state command request.
-  using on_state_type = etl::delegate<void(const TionState &state, uint32_t request_id)>;
+  /// changes is a bitmask of TionStateField changed since the previous notification.
+  using on_state_type = etl::delegate<void(const TionState &state, uint32_t changes, uint32_t request_id)>;
   /// Callback listener for response to send_heartbeat command request.
   using on_heartbeat_type = etl::delegate<void(uint8_t work_mode)>;
 
@@ -232,6 +397,27 @@ class TionApiBase {
   TionApiBase();
 
   constexpr static const char *PRESET_NONE = "none";
+  /// Id of the reserved "none" preset.
+  constexpr static uint8_t PRESET_NONE_ID = 0;
+  constexpr static uint8_t MAX_PRESETS = TION_MAX_PRESETS;
+  /// Request id of notifications with optimistic state, that was not received from the breezer.
+  constexpr static uint32_t OPTIMISTIC_REQUEST_ID = UINT32_MAX;
+  /// Request id of notifications with locally changed settings, that was not sent to the breezer.
+  constexpr static uint32_t LOCAL_REQUEST_ID = UINT32_MAX - 1;
+  /// Max number of rewrites of the state not applied by the breezer.
+  constexpr static uint8_t WRITE_MAX_RETRIES = 2;
+  /// Time to wait for the state verifying the write [ms].
+  constexpr static uint32_t WRITE_VERIFY_TIMEOUT = 3000;
+
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  struct write_stats_t {
+    // Number of writes skipped as not changing the state.
+    uint32_t suppressed;
+    // Number of rewrites of the state not applied by the breezer.
+    uint32_t retries;
+    // Number of writes not applied by the breezer after all retries.
+    uint32_t verify_failed;
+  };
 
   struct PresetData {
     // =0 - без изменений
@@ -262,6 +448,28 @@ class TionApiBase {
   const TionState &get_state() const { return this->state_; }
   const TionTraits &get_traits() const { return this->traits_; }
 
+  /// Called from the component loop, lets a transport wrapper perform deferred work.
+  virtual void loop() {
+    this->verify_expire_();
+    this->optimistic_check_();
+  }
+
+  /// Enables optimistic mode: written state is notified immediately and its fields stay pending
+  /// until the breezer confirms them. Refused or not confirmed in timeout fields are rolled back.
+  void set_optimistic(bool optimistic) { this->optimistic_ = optimistic; }
+  bool is_optimistic() const { return this->optimistic_; }
+  void set_optimistic_timeout(uint32_t timeout) { this->optimistic_timeout_ = timeout; }
+  /// Returns bitmask of TionStateField written, but not confirmed by the breezer yet.
+  uint32_t get_pending_fields() const { return this->pending_.fields; }
+  /// Returns bitmask of TionStateField written and waiting for read-back verification.
+  uint32_t get_verify_fields() const { return this->verify_.fields; }
+  const write_stats_t &get_write_stats() const { return this->write_stats_; }
+
+#ifdef TION_ENABLE_HISTORY
+  /// Returns history of received state changes.
+  const TionStateHistoryBase &get_history() const { return this->history_; }
+#endif
+
   virtual void request_state() = 0;
   virtual void write_state(TionStateCall *call) = 0;
   virtual void reset_filter() = 0;
@@ -274,14 +482,33 @@ class TionApiBase {
   void set_boost_target_temperture(int8_t target_temperature);
   // Вызывающая сторона отвественна за вызов perform.
   void enable_preset(const std::string &preset, TionStateCall *call);
+  // Вызывающая сторона отвественна за вызов perform.
+  void enable_preset(uint8_t preset_id, TionStateCall *call);
   std::set<std::string> get_presets() const;
-  bool has_presets() const { return !this->presets_.empty(); }
+  bool has_presets() const { return this->presets_count_ > 0; }
+  /// Returns number of presets, including reserved "none" preset with PRESET_NONE_ID.
+  uint8_t get_presets_size() const { return this->presets_count_ + 1; }
+  /// Returns preset id or PRESET_NONE_ID if preset is not found.
+  uint8_t find_preset(const std::string &name) const;
+  const std::string &get_preset_name(uint8_t preset_id) const;
   void add_preset(const std::string &name, const PresetData &data);
   PresetData get_preset(const std::string &name) const;
-  const std::string &get_active_preset() const { return this->active_preset_; }
+  const std::string &get_active_preset() const { return this->get_preset_name(this->active_preset_); }
+  uint8_t get_active_preset_id() const { return this->active_preset_; }
   /// Вызывающая сторона отвественна за вызов perform.
   /// @return true если были изменения и требуются выполнить perform
   bool auto_update(uint16_t current, TionStateCall *call);
+  /// Feeds the sample through auto input pipeline and updates auto mode with fused demand of all sensors.
+  bool auto_update(auto_co2::AutoSensor sensor, float value, TionStateCall *call);
+  /// @param setpoint target value of the sensor, 0 disables it. See AutoInputPipeline::set_sensor.
+  void set_auto_sensor(auto_co2::AutoSensor sensor, float setpoint) { this->auto_input_.set_sensor(sensor, setpoint); }
+  /// @param alpha EWMA smoothing factor in (0, 1] of auto mode sensors, 1 disables smoothing.
+  void set_auto_smoothing(float alpha) { this->auto_input_.set_smoothing(alpha); }
+  /// @param window number of samples of the median of auto mode sensors, up to TION_AUTO_MEDIAN_WINDOW.
+  void set_auto_median_window(uint8_t window) { this->auto_input_.set_median_window(window); }
+  /// @param timeout time after the last sample to treat auto mode sensor as stale [ms], 0 disables it.
+  void set_auto_sensor_timeout(uint32_t timeout) { this->auto_input_.set_timeout(timeout); }
+  const auto_co2::AutoInputPipeline &get_auto_input() const { return this->auto_input_; }
   void set_auto_pi_data(float kp, float ti, int db);
   void set_auto_setpoint(uint16_t setpoint) { this->auto_setpoint_ = setpoint; }
   void set_auto_min_fan_speed(uint8_t min_fan_speed);
@@ -289,6 +516,15 @@ class TionApiBase {
   uint16_t get_auto_setpoint() const { return this->auto_setpoint_; }
   uint8_t get_auto_min_fan_speed() const { return this->auto_min_fan_speed_; }
   uint8_t get_auto_max_fan_speed() const { return this->auto_max_fan_speed_; }
+  /// @param hysteresis hysteresis band in percent of the current speed airflow range, 0 disables it.
+  void set_auto_hysteresis(uint8_t hysteresis) { this->auto_output_.set_hysteresis(hysteresis); }
+  /// @param min_dwell min time to keep auto fan speed [ms], 0 disables it.
+  void set_auto_min_dwell(uint32_t min_dwell) { this->auto_output_.set_min_dwell(min_dwell); }
+  /// @param burst max number of auto fan speed changes in a row, 0 disables the limit.
+  /// @param interval time to earn one more change [ms].
+  void set_auto_rate_limit(uint8_t burst, uint32_t interval) { this->auto_output_.set_rate_limit(burst, interval); }
+  /// Returns counters of auto fan speed changes suppressed by the output stage.
+  const auto_co2::AutoOutputStage::stats_t &get_auto_stats() const { return this->auto_output_.get_stats(); }
   void set_auto_update_func(std::function<uint8_t(uint16_t current)> &&func) {
     this->auto_update_func_ = std::move(func);
   }
@@ -297,24 +533,96 @@ class TionApiBase {
  protected:
   TionTraits traits_{};
   TionState state_{};
+  // state sent with the last notification, used to find changes
+  TionState notified_state_{};
+  bool has_notified_state_{};
+  bool preset_changed_{};
   uint32_t request_id_{};
 
   TionState make_write_state_(TionStateCall *call) const;
 
+  /// Returns unique request id. 0 and 1 are skipped, as breezer responds with 1 to requests without id.
+  /// Reserved LOCAL_REQUEST_ID and OPTIMISTIC_REQUEST_ID are skipped too.
+  uint32_t next_request_id_() {
+    if (++this->request_id_ <= 1 || this->request_id_ >= LOCAL_REQUEST_ID) {
+      this->request_id_ = 2;
+    }
+    return this->request_id_;
+  }
+
   struct : public PresetData {
     uint32_t start_time;
   } boost_save_{};
 
-  std::map<std::string, PresetData> presets_;
-  std::string active_preset_{PRESET_NONE};
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  struct preset_t {
+    std::string name;
+    PresetData data;
+  };
+  // presets indexed by id, the first one is reserved "none" preset
+  preset_t presets_[MAX_PRESETS + 1]{{.name = PRESET_NONE, .data = {}}};
+  uint8_t presets_count_{};
+  uint8_t active_preset_{PRESET_NONE_ID};
+
+  bool optimistic_{};
+  // true while received state is processed
+  bool notifying_{};
+  uint32_t optimistic_timeout_{TION_OPTIMISTIC_TIMEOUT};
+  struct {
+    // bitmask of written, but not confirmed fields
+    uint32_t fields;
+    // id of the write request or 0 if not supported by the breezer
+    uint32_t request_id;
+    uint32_t time;
+    // number of states received since the write
+    uint8_t responses;
+    // written state
+    TionState target;
+    // last state received from the breezer
+    TionState device;
+  } pending_{};
 
-  auto_co2::PIController auto_pi_;
+  struct {
+    // bitmask of written fields to check in the next response
+    uint32_t fields;
+    // id of the write request or 0 if not supported by the breezer
+    uint32_t request_id;
+    // number of states received since the write
+    uint8_t responses;
+    uint8_t retries;
+    // time of the write
+    uint32_t time;
+    // written state
+    TionState target;
+  } verify_{};
+  write_stats_t write_stats_{};
+
+#ifdef TION_ENABLE_HISTORY
+  TionStateHistory<TION_HISTORY_SIZE> history_;
+#endif
+
+  auto_co2::AutoPIController auto_pi_;
+  auto_co2::AutoOutputStage auto_output_;
+  auto_co2::AutoInputPipeline auto_input_;
   int16_t auto_setpoint_{};
   uint8_t auto_min_fan_speed_{};
   uint8_t auto_max_fan_speed_{};
   std::function<uint8_t(uint16_t current)> auto_update_func_;
 
   void notify_state_(uint32_t request_id);
+  /// Returns true if the state does not change anything and must not be written.
+  bool write_suppressed_(const TionState &state);
+  /// Must be called after the state is successfully written.
+  void state_written_(const TionState &state, uint32_t request_id);
+  /// Writes the state again, when the breezer did not apply it. Returns false if not supported.
+  virtual bool write_retry_(const TionState &state, uint32_t request_id) { return false; }
+  void verify_start_(const TionState &state, uint32_t request_id);
+  void verify_check_(uint32_t request_id);
+  void verify_expire_();
+  void optimistic_apply_(const TionState &state, uint32_t request_id);
+  void optimistic_reconcile_(uint32_t request_id);
+  void optimistic_check_();
+  void optimistic_notify_();
   virtual void boost_enable_native_(bool state) {}
   void boost_enable_(uint16_t boost_time, TionStateCall *call);
   void boost_cancel_(TionStateCall *call);
@@ -322,6 +630,10 @@ class TionApiBase {
   void preset_enable_(const PresetData &preset, TionStateCall *call);
   void auto_update_fan_speed_();
   uint8_t auto_pi_update_(uint16_t current);
+  uint8_t auto_rate_to_fan_speed_(int rate) const;
+  bool auto_fan_speed_in_range_() const {
+    return this->state_.fan_speed >= this->auto_min_fan_speed_ && this->state_.fan_speed <= this->auto_max_fan_speed_;
+  }
 };
 
 }  // namespace tion
@@ -7,15 +7,22 @@ import esphome.cpp_generator as cpp
 import esphome.final_validate as fv
 from esphome import automation, core
 from esphome.components import sensor as esphome_sensor
+from esphome.components import web_server_base
 from esphome.const import (
     CONF_CO2,
     CONF_FORCE_UPDATE,
     CONF_HEATER,
+    CONF_HUMIDITY,
     CONF_ID,
+    CONF_INTERVAL,
     CONF_LAMBDA,
     CONF_ON_STATE,
+    CONF_PM_2_5,
     CONF_POWER,
+    CONF_SENSOR,
+    CONF_SIZE,
     CONF_TEMPERATURE,
+    CONF_TIMEOUT,
     CONF_TYPE,
 )
 from esphome.core import ID
@@ -34,10 +41,18 @@ CONF_FAN_SPEED = "fan_speed"
 CONF_GATE_POSITION = "gate_position"
 CONF_AUTO = "auto"
 CONF_BUTTON_PRESETS = "button_presets"
+# see TION_MAX_PRESETS in tion-api-defines.h
+DEFAULT_MAX_PRESETS = 8
+DEFAULT_MEDIAN_WINDOW = 5
 
 CONF_STATE_TIMEOUT = "state_timeout"
 CONF_STATE_WARNOUT = "state_warnout"
 CONF_BATCH_TIMEOUT = "batch_timeout"
+CONF_OPTIMISTIC = "optimistic"
+CONF_POLL_WINDOW = "poll_window"
+CONF_MIN_UPDATE_INTERVAL = "min_update_interval"
+CONF_MAX_UPDATE_INTERVAL = "max_update_interval"
+CONF_HISTORY = "history"
 
 CONF_SETPOINT = "setpoint"
 CONF_MIN_FAN_SPEED = f"min_{CONF_FAN_SPEED}"
@@ -46,6 +61,14 @@ CONF_PI_CONTROLLER = "pi_controller"
 CONF_KP = "kp"
 CONF_TI = "ti"
 CONF_DB = "db"
+CONF_FIXED_POINT = "fixed_point"
+CONF_HYSTERESIS = "hysteresis"
+CONF_MIN_DWELL = "min_dwell"
+CONF_RATE_LIMIT = "rate_limit"
+CONF_BURST = "burst"
+CONF_VOC = "voc"
+CONF_SMOOTHING = "smoothing"
+CONF_MEDIAN_WINDOW = "median_window"
 
 tion_ns = cg.esphome_ns.namespace("tion")
 dentra_tion_ns = cg.global_ns.namespace("dentra").namespace("tion")
@@ -55,9 +78,13 @@ TionApiComponent = tion_ns.class_("TionApiComponent", cg.Component)
 
 TionStateRef = dentra_tion_ns.namespace("TionState").operator("ref").operator("const")
 TionGatePosition = dentra_tion_ns.namespace("TionGatePosition")
+AutoSensor = dentra_tion_ns.namespace("auto_co2").enum("AutoSensor")
 
 StateTrigger = tion_ns.class_("StateTrigger", automation.Trigger.template(TionStateRef))
 
+# types with pipelined poll cycle
+POLL_WINDOW_TYPES = ["4s", "o2"]
+
 BREEZER_TYPES = {
     "o2": tion_ns.class_("TionO2ApiComponent", TionApiComponent),
     "3s": tion_ns.class_("Tion3sApiComponent", TionApiComponent),
@@ -65,6 +92,14 @@ BREEZER_TYPES = {
     "lt": tion_ns.class_("TionLtApiComponent", TionApiComponent),
 }
 
+# see TionBuildTraits in tion-api.h
+STATIC_TRAITS = {
+    "o2": dentra_tion_ns.class_("TionO2StaticTraits"),
+    "3s": dentra_tion_ns.class_("Tion3sStaticTraits"),
+    "4s": dentra_tion_ns.class_("Tion4sStaticTraits"),
+    "lt": dentra_tion_ns.class_("TionLtStaticTraits"),
+}
+
 PRESET_GATE_POSITIONS = {
     "none": TionGatePosition.NONE,
     "outdoor": TionGatePosition.OUTDOOR,
@@ -97,9 +132,33 @@ BUTTON_PRESETS_SCHEMA = cv.Schema(
     }
 )
 
+# auto mode sensors besides co2: enum value and default setpoint
+AUTO_SENSORS = {
+    CONF_PM_2_5: (AutoSensor.AUTO_SENSOR_PM25, 25),
+    CONF_VOC: (AutoSensor.AUTO_SENSOR_VOC, 250),
+    CONF_HUMIDITY: (AutoSensor.AUTO_SENSOR_HUMIDITY, 65),
+}
+
+
+def _auto_sensor_schema(setpoint):
+    return cv.Schema(
+        {
+            cv.Required(CONF_SENSOR): cv.use_id(esphome_sensor.Sensor),
+            cv.Optional(CONF_SETPOINT, default=setpoint): cv.positive_not_null_float,
+        }
+    )
+
+
 AUTO_SCHEMA = cv.Schema(
     {
         cv.Required(CONF_CO2): cv.use_id(esphome_sensor.Sensor),
+        **{
+            cv.Optional(key): _auto_sensor_schema(setpoint)
+            for key, (_, setpoint) in AUTO_SENSORS.items()
+        },
+        cv.Optional(CONF_SMOOTHING): cv.float_range(min=0.01, max=1.0),
+        cv.Optional(CONF_MEDIAN_WINDOW, default=DEFAULT_MEDIAN_WINDOW): cv.int_range(1, 15),
+        cv.Optional(CONF_TIMEOUT): cv.positive_time_period_milliseconds,
         cv.Optional(CONF_SETPOINT): cv.int_range(500, 1400),
         cv.Inclusive(CONF_MIN_FAN_SPEED, "auto_fan_speed"): cv.int_range(0, 5),
         cv.Inclusive(CONF_MAX_FAN_SPEED, "auto_fan_speed"): cv.int_range(1, 6),
@@ -108,14 +167,45 @@ AUTO_SCHEMA = cv.Schema(
                 cv.Optional(CONF_KP, default=0.2736): cv.float_range(min=0.001),
                 cv.Optional(CONF_TI, default=8): cv.float_range(min=0.001),
                 cv.Optional(CONF_DB, default=20): cv.int_range(-100, 100),
+                cv.Optional(CONF_FIXED_POINT): cv.boolean,
             },
             None,
         ),
         cv.Exclusive(CONF_LAMBDA, "auto_mode"): cv.returning_lambda,
+        cv.Optional(CONF_HYSTERESIS): cv.All(cv.percentage_int, cv.int_range(0, 100)),
+        cv.Optional(CONF_MIN_DWELL): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_RATE_LIMIT): cv.Any(
+            cv.Schema(
+                {
+                    cv.Required(CONF_BURST): cv.int_range(1, 255),
+                    cv.Required(CONF_INTERVAL): cv.positive_time_period_milliseconds,
+                }
+            ),
+            None,
+        ),
     }
 )
 
 
+HISTORY_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_SIZE, default=256): cv.int_range(min=16, max=4096),
+        cv.Optional(web_server_base.CONF_WEB_SERVER_BASE_ID): cv.use_id(
+            web_server_base.WebServerBase
+        ),
+    }
+)
+
+
+def _validate_poll_window(config):
+    for conf in config:
+        if CONF_POLL_WINDOW in conf and conf[CONF_TYPE] not in POLL_WINDOW_TYPES:
+            raise cv.Invalid(
+                f"{CONF_POLL_WINDOW} is supported only by {', '.join(POLL_WINDOW_TYPES)}"
+            )
+    return config
+
+
 def check_type(key, typ, required: bool = False):
     return cgp.validate_type(key, typ, required)
 
@@ -133,14 +223,24 @@ CONFIG_SCHEMA = cv.All(
                     CONF_BATCH_TIMEOUT, default="200ms"
                 ): cv.positive_time_period_milliseconds,
                 cv.Optional(CONF_FORCE_UPDATE): cv.boolean,
+                cv.Optional(CONF_OPTIMISTIC): cv.boolean,
+                cv.Optional(CONF_POLL_WINDOW): cv.int_range(1, 4),
+                cv.Inclusive(
+                    CONF_MIN_UPDATE_INTERVAL, "adaptive_update_interval"
+                ): cv.update_interval,
+                cv.Inclusive(
+                    CONF_MAX_UPDATE_INTERVAL, "adaptive_update_interval"
+                ): cv.update_interval,
                 cv.Optional(CONF_PRESETS): cv.Schema({cv.string_strict: PRESET_SCHEMA}),
                 cv.Optional(CONF_ON_STATE): cgp.automation_schema(StateTrigger),
                 cv.Optional(CONF_AUTO): AUTO_SCHEMA,
+                cv.Optional(CONF_HISTORY): HISTORY_SCHEMA,
             }
         )
         .extend(vport.VPORT_CLIENT_SCHEMA)
         .extend(cv.polling_component_schema("15s")),
         cgp.validate_type(CONF_BUTTON_PRESETS, "lt"),
+        _validate_poll_window,
     ),
 )
 
@@ -172,6 +272,7 @@ async def _setup_tion_api(config: dict):
     await cg.register_component(var, config)
 
     cg.add(var.set_component_source(f"tion[type={config[CONF_TYPE]}]"))
+    cg.add(var.set_vport_api(api))
 
     # cg.add_library("tion-api", None, "https://github.com/dentra/tion-api")
     cg.add_build_flag("-DTION_ESPHOME")
@@ -179,13 +280,30 @@ async def _setup_tion_api(config: dict):
     cg.add(var.set_state_timeout(config[CONF_STATE_TIMEOUT]))
     cg.add(var.set_batch_timeout(config[CONF_BATCH_TIMEOUT]))
     cgp.setup_value(config, CONF_FORCE_UPDATE, var.set_force_update)
+    cgp.setup_value(config, CONF_OPTIMISTIC, var.set_optimistic)
+    cgp.setup_value(config, CONF_POLL_WINDOW, api.set_poll_window)
+    if CONF_MAX_UPDATE_INTERVAL in config:
+        cg.add(
+            var.set_adaptive_interval(
+                config[CONF_MIN_UPDATE_INTERVAL], config[CONF_MAX_UPDATE_INTERVAL]
+            )
+        )
 
     return var
 
 
-def _setup_tion_api_presets(config: dict, var: cg.MockObj):
+async def _setup_history(config: dict, var: cg.MockObj, component_id: ID):
+    cg.add_build_flag("-DTION_ENABLE_HISTORY")
+    if web_server_base.CONF_WEB_SERVER_BASE_ID in config:
+        base = await cg.get_variable(config[web_server_base.CONF_WEB_SERVER_BASE_ID])
+        cg.add_define("USE_TION_HISTORY_WEB")
+        cg.add(var.set_history_web(base, component_id.id))
+
+
+def _setup_tion_api_presets(config: dict, var: cg.MockObj) -> int:
+    # returns number of added presets
     if CONF_PRESETS not in config:
-        return
+        return 0
 
     presets = set()
     for preset in config[CONF_PRESETS]:
@@ -217,6 +335,8 @@ def _setup_tion_api_presets(config: dict, var: cg.MockObj):
 
         presets.add(preset_name)
 
+    return len(presets)
+
 
 def _setup_tion_api_button_presets(config: dict, var: cg.MockObj):
     if CONF_BUTTON_PRESETS not in config:
@@ -234,12 +354,12 @@ def _setup_tion_api_button_presets(config: dict, var: cg.MockObj):
     )
 
 
-async def _setup_auto(config: dict, var):
+async def _setup_auto_sensor(sensor_id: ID, sensor, var):
     api = var.Papi()
 
     code = f"""
-auto *call = {var}->make_call();
-if ({api}->auto_update(x, call)) {{
+auto *call = {var}->make_call(true);
+if ({api}->auto_update({sensor}, x, call)) {{
   call->perform();
 }}
 """
@@ -248,17 +368,40 @@ if ({api}->auto_update(x, call)) {{
         value=core.Lambda(code.strip()), parameters=[(cg.float_, "x")], capture=""
     )
 
-    cg.add(cg.MockObj(config[CONF_CO2].id, "->").add_on_state_callback(lam))
+    cg.add(cg.MockObj(sensor_id, "->").add_on_state_callback(lam))
+
+
+async def _setup_auto(config: dict, var):
+    api = var.Papi()
+
+    await _setup_auto_sensor(config[CONF_CO2].id, AutoSensor.AUTO_SENSOR_CO2, var)
+    for key, (sensor, _) in AUTO_SENSORS.items():
+        if key in config:
+            cg.add(api.set_auto_sensor(sensor, config[key][CONF_SETPOINT]))
+            await _setup_auto_sensor(config[key][CONF_SENSOR].id, sensor, var)
+
+    cgp.setup_value(config, CONF_SMOOTHING, api.set_auto_smoothing)
+    cgp.setup_value(config, CONF_TIMEOUT, api.set_auto_sensor_timeout)
+    cgp.setup_value(config, CONF_MEDIAN_WINDOW, api.set_auto_median_window)
 
     cgp.setup_value(config, CONF_SETPOINT, api.set_auto_setpoint)
     cgp.setup_value(config, CONF_MIN_FAN_SPEED, api.set_auto_min_fan_speed)
     cgp.setup_value(config, CONF_MAX_FAN_SPEED, api.set_auto_max_fan_speed)
 
+    pi_config = config.get(CONF_PI_CONTROLLER) or {}
     if CONF_PI_CONTROLLER in config:
-        cgp.setup_values(
-            config[CONF_PI_CONTROLLER] or {},
-            [CONF_KP, CONF_TI, CONF_DB],
-            api.set_auto_pi_data,
+        cgp.setup_values(pi_config, [CONF_KP, CONF_TI, CONF_DB], api.set_auto_pi_data)
+    # esp8266 has no FPU, so fixed point is default there even without pi_controller
+    if pi_config.get(CONF_FIXED_POINT, core.CORE.is_esp8266):
+        cg.add_build_flag("-DTION_AUTO_PI_FIXED")
+
+    cgp.setup_value(config, CONF_HYSTERESIS, api.set_auto_hysteresis)
+    cgp.setup_value(config, CONF_MIN_DWELL, api.set_auto_min_dwell)
+    if CONF_RATE_LIMIT in config:
+        # null disables the limit
+        rate_limit = config[CONF_RATE_LIMIT] or {CONF_BURST: 0, CONF_INTERVAL: 0}
+        cg.add(
+            api.set_auto_rate_limit(rate_limit[CONF_BURST], rate_limit[CONF_INTERVAL])
         )
 
     await cgp.setup_lambda(
@@ -270,14 +413,38 @@ if ({api}->auto_update(x, call)) {{
     )
 
 
+def _setup_static_traits(config: list[dict]):
+    # features of used models are resolved at compile time
+    types = sorted({conf[CONF_TYPE] for conf in config})
+    traits = ",".join(str(STATIC_TRAITS[typ]) for typ in types)
+    cg.add_build_flag(f"-DTION_STATIC_TRAITS={traits}")
+
+
 async def to_code(config: dict):
+    _setup_static_traits(config)
+    max_presets = 0
+    max_history = 0
+    max_median_window = DEFAULT_MEDIAN_WINDOW
     for conf in config:
         var = await _setup_tion_api(conf)
-        _setup_tion_api_presets(conf, var)
+        max_presets = max(max_presets, _setup_tion_api_presets(conf, var))
         _setup_tion_api_button_presets(conf, var)
         await cgp.setup_automation(conf, CONF_ON_STATE, var, (TionStateRef, "x"))
         if CONF_AUTO in conf:
             await _setup_auto(conf[CONF_AUTO], var)
+            max_median_window = max(max_median_window, conf[CONF_AUTO][CONF_MEDIAN_WINDOW])
+        if CONF_HISTORY in conf:
+            await _setup_history(conf[CONF_HISTORY], var, conf[CONF_ID])
+            max_history = max(max_history, conf[CONF_HISTORY][CONF_SIZE])
+    # preset table size is shared by all breezers
+    if max_presets > DEFAULT_MAX_PRESETS:
+        cg.add_build_flag(f"-DTION_MAX_PRESETS={max_presets}")
+    # history size is shared by all breezers too
+    if max_history > 0:
+        cg.add_build_flag(f"-DTION_HISTORY_SIZE={max_history}")
+    # median buffers are sized for the largest window, each breezer sets its own
+    if max_median_window > DEFAULT_MEDIAN_WINDOW:
+        cg.add_build_flag(f"-DTION_AUTO_MEDIAN_WINDOW={max_median_window}")
 
 
 def new_pc(pc_cfg: dict[str, str | dict[str, Any]]):
@@ -38,7 +38,7 @@ class TionBinarySensor : public binary_sensor::BinarySensor, public Component, p
     if (!PC::is_supported(this)) {
       return;
     }
-    this->parent_->add_on_state_callback([this](const TionState *state) {
+    this->parent_->add_on_state_callback(PC::state_fields(), [this](const TionState *state) {
       if (!PC::publish_state(this, state)) {
         this->has_state_ = false;
         this->state_callback_.call(false);
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "esphome/core/log.h"
 
 #include "tion_climate_helpers.h"
@@ -25,13 +27,26 @@ int find_climate_preset(const std::string &preset) {
 void TionClimate::setup() {
   ESP_LOGD(TAG, "Setting up %s...", this->get_name().c_str());
 
-  this->parent_->add_on_state_callback([this](const TionState *state) {
+  this->setup_presets_();
+
+  this->parent_->add_on_state_callback(STATE_FIELDS, [this](const TionState *state) {
     if (state) {
       this->on_state_(*state);
     }
   });
 }
 
+void TionClimate::setup_presets_() {
+  auto *api = this->parent_->api();
+  for (uint8_t id = 0; id < api->get_presets_size(); id++) {
+    const auto climate_preset = find_climate_preset(api->get_preset_name(id));
+    this->climate_presets_[id] = climate_preset;
+    if (climate_preset >= 0) {
+      this->preset_ids_[climate_preset] = id;
+    }
+  }
+}
+
 climate::ClimateTraits TionClimate::traits() {
   auto traits = climate::ClimateTraits();
   traits.set_supports_current_temperature(true);
@@ -54,10 +69,11 @@ climate::ClimateTraits TionClimate::traits() {
   }
 
   if (this->parent_->api()->has_presets()) {
-    for (auto &&preset : this->parent_->api()->get_presets()) {
-      const auto preset_index = find_climate_preset(preset);
+    const auto *api = this->parent_->api();
+    for (uint8_t id = 0; id < api->get_presets_size(); id++) {
+      const auto preset_index = this->climate_presets_[id];
       if (preset_index < 0) {
-        traits.add_supported_custom_preset(preset);
+        traits.add_supported_custom_preset(api->get_preset_name(id));
       } else {
         traits.add_supported_preset(static_cast<climate::ClimatePreset>(preset_index));
       }
@@ -73,19 +89,15 @@ void TionClimate::dump_config() {
 }
 
 void TionClimate::control(const climate::ClimateCall &call) {
-  auto *tion = this->parent_->make_call();
+  auto *tion = this->parent_->make_call(true);
 
   if (this->parent_->api()->has_presets()) {
 #ifndef USE_ARDUINO
-    if (call.get_preset().has_value()) {
-      const auto preset_climate = LOG_STR_ARG(climate::climate_preset_to_string(*call.get_preset()));
-      for (auto &&preset : this->parent_->api()->get_presets()) {
-        const auto preset_upper = str_upper_case(preset);
-        if (preset_upper == preset_climate) {
-          ESP_LOGD(TAG, "Set preset %s", preset.c_str());
-          this->parent_->api()->enable_preset(preset, tion);
-          break;
-        }
+    if (call.get_preset().has_value() && *call.get_preset() <= climate::CLIMATE_PRESET_ACTIVITY) {
+      const auto preset_id = this->preset_ids_[*call.get_preset()];
+      if (preset_id >= 0) {
+        ESP_LOGD(TAG, "Set preset %s", this->parent_->api()->get_preset_name(preset_id).c_str());
+        this->parent_->api()->enable_preset(static_cast<uint8_t>(preset_id), tion);
       }
     }
 #endif
@@ -183,9 +195,10 @@ void TionClimate::on_state_(const TionState &state) {
   }
 
   if (this->parent_->api()->has_presets()) {
-    const auto active_preset = this->parent_->api()->get_active_preset();
+    const auto active_preset_id = this->parent_->api()->get_active_preset_id();
+    const auto &active_preset = this->parent_->api()->get_preset_name(active_preset_id);
 #ifndef USE_ARDUINO
-    const auto climate_preset = find_climate_preset(active_preset);
+    const auto climate_preset = this->climate_presets_[active_preset_id];
     if (climate_preset >= 0) {
       if (this->preset.value_or(static_cast<climate::ClimatePreset>(-1)) != climate_preset) {
         this->preset = static_cast<climate::ClimatePreset>(climate_preset);
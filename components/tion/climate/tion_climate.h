@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <iterator>
+
 #include "esphome/core/defines.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/component.h"
@@ -15,7 +18,10 @@ class TionClimate : public climate::Climate, public Component, public Parented<T
   using TionState = dentra::tion::TionState;
 
  public:
-  explicit TionClimate(TionApiComponent *api) : Parented(api) {}
+  explicit TionClimate(TionApiComponent *api) : Parented(api) {
+    std::fill(std::begin(this->climate_presets_), std::end(this->climate_presets_), -1);
+    std::fill(std::begin(this->preset_ids_), std::end(this->preset_ids_), -1);
+  }
 
   float get_setup_priority() const override { return setup_priority::AFTER_WIFI; }
   void dump_config() override;
@@ -28,8 +34,20 @@ class TionClimate : public climate::Climate, public Component, public Parented<T
   void set_enable_fan_auto(bool enable_fan_auto) { this->enable_fan_auto_ = enable_fan_auto; }
 
  protected:
+  // state fields the climate depends on
+  static constexpr uint32_t STATE_FIELDS =
+      dentra::tion::STATE_FIELD_POWER | dentra::tion::STATE_FIELD_HEATER | dentra::tion::STATE_FIELD_AUTO |
+      dentra::tion::STATE_FIELD_HEATER_VAR | dentra::tion::STATE_FIELD_OUTDOOR_TEMPERATURE |
+      dentra::tion::STATE_FIELD_CURRENT_TEMPERATURE | dentra::tion::STATE_FIELD_TARGET_TEMPERATURE |
+      dentra::tion::STATE_FIELD_FAN_SPEED | dentra::tion::STATE_FIELD_PRESET | dentra::tion::STATE_FIELD_AUTO_SETTINGS;
+
   bool enable_heat_cool_{};
   bool enable_fan_auto_{};
+  // climate preset for each api preset id or -1 for custom preset
+  int8_t climate_presets_[dentra::tion::TionApiBase::MAX_PRESETS + 1];
+  // api preset id for each climate preset or -1 if there is no such preset
+  int8_t preset_ids_[climate::CLIMATE_PRESET_ACTIVITY + 1];
+  void setup_presets_();
   void on_state_(const TionState &state);
   bool set_fan_speed_(uint8_t fan_speed);
 };
@@ -11,7 +11,7 @@ static const char *const TAG = "tion_fan";
 void TionFan::setup() {
   ESP_LOGD(TAG, "Setting up %s...", this->get_name().c_str());
 
-  this->parent_->add_on_state_callback([this](const TionState *state) {
+  this->parent_->add_on_state_callback(STATE_FIELDS, [this](const TionState *state) {
     if (state) {
       this->on_state_(*state);
     }
@@ -20,8 +20,13 @@ void TionFan::setup() {
 
 fan::FanTraits TionFan::get_traits() {
   auto traits = fan::FanTraits(false, true, false, this->parent_->traits().max_fan_speed);
-  if (this->parent_->api()->has_presets()) {
-    traits.set_supported_preset_modes(this->parent_->api()->get_presets());
+  const auto *api = this->parent_->api();
+  if (api->has_presets()) {
+    std::set<std::string> presets;
+    for (uint8_t id = 0; id < api->get_presets_size(); id++) {
+      presets.emplace(api->get_preset_name(id));
+    }
+    traits.set_supported_preset_modes(presets);
   }
   return traits;
 }
@@ -29,7 +34,7 @@ fan::FanTraits TionFan::get_traits() {
 void TionFan::dump_config() { LOG_FAN("", "Tion Fan", this); }
 
 void TionFan::control(const fan::FanCall &call) {
-  auto *tion = this->parent_->make_call();
+  auto *tion = this->parent_->make_call(true);
 
   if (this->parent_->api()->has_presets()) {
     auto preset_mode = call.get_preset_mode();
@@ -24,6 +24,10 @@ class TionFan : public fan::Fan, public Component, public Parented<TionApiCompon
   fan::FanTraits get_traits() override;
 
  protected:
+  // state fields the fan depends on
+  static constexpr uint32_t STATE_FIELDS =
+      dentra::tion::STATE_FIELD_POWER | dentra::tion::STATE_FIELD_FAN_SPEED | dentra::tion::STATE_FIELD_PRESET;
+
   void control(const fan::FanCall &call) override;
   void on_state_(const TionState &state);
 };
@@ -46,7 +46,7 @@ template<class C> class TionSelect : public select::Select, public Component, pu
     for (auto &&opt : options) {
       ESP_LOGD(TAG, "  '%s'", opt.c_str());
     }
-    this->parent_->add_on_state_callback([this](const TionState *state) {
+    this->parent_->add_on_state_callback(PC::state_fields(), [this](const TionState *state) {
       if (state) {
         if constexpr (PC::checker().has_api_get()) {
           this->internal_publish_state_(C::get(this->parent_));
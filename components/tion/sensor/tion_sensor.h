@@ -37,7 +37,7 @@ template<class C> class TionSensor : public sensor::Sensor, public Component, pu
     if (!PC::is_supported(this)) {
       return;
     }
-    this->parent_->add_on_state_callback([this](const TionState *state) {
+    this->parent_->add_on_state_callback(PC::state_fields(), [this](const TionState *state) {
       if (!PC::publish_state(this, state)) {
         this->has_state_ = false;
         this->callback_.call(NAN);
@@ -42,7 +42,7 @@ template<class C> class TionSwitch : public switch_::Switch, public Component, p
       return;
     }
     this->parent_->add_on_state_callback(
-        [this](const TionState *state) { this->has_state_ = PC::publish_state(this, state); });
+        PC::state_fields(), [this](const TionState *state) { this->has_state_ = PC::publish_state(this, state); });
   }
 
   bool assumed_state() override { return this->is_failed(); }
@@ -35,7 +35,7 @@ class TionTextSensor : public text_sensor::TextSensor, public Component, public
   void setup() override {
     ESP_LOGD(TAG, "Setting up %s...", this->get_name().c_str());
 
-    this->parent_->add_on_state_callback([this](const TionState *state) {
+    this->parent_->add_on_state_callback(PC::state_fields(), [this](const TionState *state) {
       if (!PC::publish_state(this, state)) {
         this->has_state_ = false;
         this->callback_.call("");
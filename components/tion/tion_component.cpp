@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cinttypes>
 #include <ctime>
 
@@ -10,37 +11,133 @@ namespace tion {
 static const char *const TAG = "tion_api_component";
 static const char *const STATE_TIMEOUT = "state_timeout";
 static const char *const BATCH_TIMEOUT = "batch_timeout";
+// name of the PollingComponent interval
+static const char *const UPDATE_INTERVAL = "update";
 
-void TionApiComponent::BatchStateCall::perform() {
-  this->start_time_ = millis();
-  if (this->c_->batch_timeout_) {
-    this->c_->set_timeout(BATCH_TIMEOUT, this->c_->batch_timeout_, [this]() { this->perform_(); });
+void TionApiComponent::BatchCoalescer::perform() {
+  const bool final = this->final_;
+  this->final_ = false;
+  if (this->start_time_ == 0) {
+    if (!this->has_changes()) {
+      return;
+    }
+    this->start_time_ = millis();
+    this->performs_ = 0;
+  }
+  if (this->performs_ < UINT8_MAX) {
+    this->performs_++;
+  }
+
+  // changes arrived later do not postpone the write of the first one
+  const uint32_t elapsed = millis() - this->start_time_;
+  if ((final && this->performs_ == 1) || elapsed >= this->c_->batch_timeout_) {
+    this->schedule_(0);
+  } else {
+    this->schedule_(this->c_->batch_timeout_ - elapsed);
+  }
+}
+
+void TionApiComponent::BatchCoalescer::schedule_(uint32_t delay) {
+  if (delay == 0) {
+    this->c_->cancel_timeout(BATCH_TIMEOUT);
+    this->flush_();
   } else {
-    this->perform_();
+    this->c_->set_timeout(BATCH_TIMEOUT, delay, [this]() { this->flush_(); });
   }
 }
 
-void TionApiComponent::BatchStateCall::perform_() {
+bool TionApiComponent::BatchCoalescer::is_holding_() const {
+  return this->confirm_start_time_ != 0 && this->c_->api_->get_verify_fields() != 0 &&
+         millis() - this->sent_time_ < this->c_->state_timeout_;
+}
+
+void TionApiComponent::BatchCoalescer::flush_(bool force) {
+  if (this->start_time_ == 0) {
+    return;
+  }
+  if (!force && this->is_holding_()) {
+    ESP_LOGD(TAG, "Hold batch changes until the previous write is confirmed");
+    // the breezer may not respond at all
+    this->c_->set_timeout(BATCH_TIMEOUT, this->c_->state_timeout_ - (millis() - this->sent_time_),
+                          [this]() { this->flush_(true); });
+    return;
+  }
+
   ESP_LOGD(TAG, "Write out batch changes");
 #ifdef TION_ENABLE_API_CONTROL_CALLBACK
   this->c_->control_callback_.call(this);
 #endif
-  dentra::tion::TionStateCall::perform();
+  const uint32_t now = millis();
+  this->send_latency_.add(now - this->start_time_);
+  this->confirm_start_time_ = this->start_time_;
+  this->sent_time_ = now;
   this->start_time_ = 0;
+  this->performs_ = 0;
+  dentra::tion::TionStateCall::perform();
+  // nothing to verify when the write was suppressed or is verified already
+  if (this->confirm_start_time_ != 0 && this->c_->api_->get_verify_fields() == 0) {
+    this->confirmed_();
+  }
   this->c_->state_check_schedule_();
+  this->c_->poll_fast_start_();
+}
+
+void TionApiComponent::BatchCoalescer::on_state() {
+  if (this->confirm_start_time_ == 0 || this->c_->api_->get_verify_fields() != 0) {
+    return;
+  }
+  this->confirmed_();
+  // the batch waiting for the confirmation is written if its time has come
+  if (this->start_time_ != 0 && millis() - this->start_time_ >= this->c_->batch_timeout_) {
+    this->schedule_(0);
+  }
+}
+
+void TionApiComponent::BatchCoalescer::confirmed_() {
+  const uint32_t latency = millis() - this->confirm_start_time_;
+  ESP_LOGV(TAG, "Batch confirmed in %" PRIu32 " ms", latency);
+  this->confirm_latency_.add(latency);
+  this->confirm_start_time_ = 0;
 }
 
 void TionApiComponent::call_setup() {
   PollingComponent::call_setup();
+#ifdef USE_TION_HISTORY_WEB
+  if (this->history_web_) {
+    this->history_web_->add_handler(
+        new TionHistoryHandler(&this->api_->get_history(), this->history_web_id_));  // NOLINT
+  }
+#endif
   if (this->state_timeout_ >= this->get_update_interval()) {
     ESP_LOGW(TAG, "Invalid state timeout: %.1f s", this->state_timeout_ * 0.001f);
     this->state_timeout_ = 0;
   }
+  if (this->poll_max_interval_ != 0) {
+    // state timeout is restarted on each poll, so it must be shorter than any interval
+    if (this->poll_min_interval_ <= this->state_timeout_ || this->poll_min_interval_ > this->get_update_interval()) {
+      ESP_LOGW(TAG, "Invalid min update interval: %.1f s", this->poll_min_interval_ * 0.001f);
+      this->poll_min_interval_ = this->get_update_interval();
+    }
+    if (this->poll_max_interval_ < this->get_update_interval()) {
+      ESP_LOGW(TAG, "Invalid max update interval: %.1f s", this->poll_max_interval_ * 0.001f);
+      this->poll_max_interval_ = this->get_update_interval();
+    }
+  }
 }
 
 // обработка и обновление App.app_state_ происходит только для компонентов
 // переопределяющих loop или call_loop (см. application.cpp:148)
-void TionApiComponent::call_loop() { PollingComponent::call_loop(); }
+void TionApiComponent::call_loop() {
+  PollingComponent::call_loop();
+  this->api_->loop();
+}
+
+static void dump_latency(const char *name, const TionApiComponent::LatencyHistogram &latency) {
+  ESP_LOGCONFIG(TAG,
+                "  %s: %" PRIu32 " batches, mean %" PRIu32 " ms, p50 < %" PRIu32 " ms, p95 < %" PRIu32
+                " ms, max %" PRIu32 " ms",
+                name, latency.count(), latency.mean(), latency.percentile(50), latency.percentile(95), latency.max());
+}
 
 void TionApiComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "%s:", this->get_component_source());
@@ -48,9 +145,48 @@ void TionApiComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "  Force update: %s", ONOFF(this->force_update_));
   ESP_LOGCONFIG(TAG, "  State timeout: %.1f s", this->state_timeout_ * 0.001f);
   ESP_LOGCONFIG(TAG, "  Batch timeout: %.1f s", this->batch_timeout_ * 0.001f);
-  if (this->traits().supports_manual_antifrize) {
+  ESP_LOGCONFIG(TAG, "  Optimistic: %s", ONOFF(this->api_->is_optimistic()));
+#ifdef TION_ENABLE_HISTORY
+  ESP_LOGCONFIG(TAG, "  History size: %zu", this->api_->get_history().capacity());
+#endif
+  if (this->poll_max_interval_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Adaptive update interval: %.1f - %.1f s", this->poll_min_interval_ * 0.001f,
+                  this->poll_max_interval_ * 0.001f);
+  }
+  if (this->traits().supports<dentra::tion::FEATURE_MANUAL_ANTIFRIZE>()) {
     ESP_LOGCONFIG(TAG, "  Manual antifrize: enabled");
   }
+  dump_latency("Batch send latency", this->get_send_latency());
+  dump_latency("Batch confirm latency", this->get_confirm_latency());
+  if (this->requests_ != nullptr) {
+    const auto &stats = this->requests_->get_stats();
+    ESP_LOGCONFIG(TAG, "  Requests: %" PRIu32 " completed, %" PRIu32 " retries, %" PRIu32 " timeouts", stats.completed,
+                  stats.retries, stats.timeouts);
+    ESP_LOGCONFIG(TAG, "  State RTT: p50 < %" PRIu32 " ms, p95 < %" PRIu32 " ms",
+                  this->requests_->get_rtt_percentile(this->state_type_, 50),
+                  this->requests_->get_rtt_percentile(this->state_type_, 95));
+    ESP_LOGCONFIG(TAG, "  Link: %s", this->requests_->is_link_lost() ? "lost" : "ok");
+  }
+  if (this->tx_queue_ != nullptr) {
+    dump_tx_queue(TAG, *this->tx_queue_);
+  }
+}
+
+void TionApiComponent::set_request_tracker(dentra::tion::TionRequestTracker *requests) {
+  this->requests_ = requests;
+  requests->set_on_timeout(dentra::tion::TionRequestTracker::on_timeout_type::create<
+                           TionApiComponent, &TionApiComponent::on_request_timeout_>(*this));
+}
+
+void TionApiComponent::on_request_timeout_(uint16_t rsp_type, uint32_t request_id) {
+  if (this->requests_->is_link_lost() && !this->status_has_warning()) {
+    ESP_LOGW(TAG, "Link lost");
+    this->status_set_warning("Link lost");
+  }
+  // no need to wait the rest of state timeout
+  if (this->state_type_ != 0 && rsp_type == this->state_type_ && this->cancel_timeout(STATE_TIMEOUT)) {
+    this->state_lost_();
+  }
 }
 
 void TionApiComponent::update() {
@@ -58,38 +194,193 @@ void TionApiComponent::update() {
   this->state_check_schedule_();
 }
 
-void TionApiComponent::on_state_(const TionState &state, const uint32_t request_id) {
-  ESP_LOGV(TAG, "State received, request_id: %" PRIu32, request_id);
-  // clear error reporting
-  this->status_clear_error();
-  this->cancel_timeout(STATE_TIMEOUT);
-  // notify state
-  this->defer([this]() { this->state_callback_.call(&this->state()); });
+void TionApiComponent::on_state_(const TionState &state, uint32_t changes, uint32_t request_id) {
+  ESP_LOGV(TAG, "State received, request_id: %" PRIu32 ", changes: 0x%08" PRIX32, request_id, changes);
+  // optimistic or local state is not a response, so it does not prove the link
+  if (request_id != TionApiBase::OPTIMISTIC_REQUEST_ID && request_id != TionApiBase::LOCAL_REQUEST_ID) {
+    // clear error reporting
+    if (this->status_has_error()) {
+      // state was lost, so subscribers must refresh all fields
+      changes = dentra::tion::STATE_FIELD_ALL;
+    }
+    this->status_clear_error();
+    this->status_clear_warning();
+    this->cancel_timeout(STATE_TIMEOUT);
+    this->poll_adapt_(changes);
+    this->batch_.on_state();
+  }
+  if (this->force_update_) {
+    changes = dentra::tion::STATE_FIELD_ALL;
+  }
+  // notify state, changes are accumulated until the deferred call
+  this->state_changes_ |= changes;
+  this->defer([this]() {
+    const uint32_t changes = this->state_changes_;
+    this->state_changes_ = 0;
+    this->notify_state_(&this->state(), changes);
+  });
+}
+
+void TionApiComponent::notify_state_(const TionState *state, uint32_t changes) {
+  this->state_callback_.call(state, changes);
+
+  if (state == nullptr || changes == dentra::tion::STATE_FIELD_ALL) {
+    for (auto &subscriber : this->state_subscribers_) {
+      subscriber.callback(state);
+    }
+    return;
+  }
+
+  // only subscribers of changed fields are called, each one once
+  this->state_epoch_++;
+  for (uint32_t bits = changes; bits != 0; bits &= bits - 1) {
+    const auto bit = __builtin_ctz(bits);
+    for (auto i = this->field_index_[bit]; i < this->field_index_[bit + 1]; i++) {
+      auto &subscriber = this->state_subscribers_[this->field_subscribers_[i]];
+      if (subscriber.epoch != this->state_epoch_) {
+        subscriber.epoch = this->state_epoch_;
+        subscriber.callback(state);
+      }
+    }
+  }
+}
+
+void TionApiComponent::add_on_state_callback(uint32_t fields, std::function<void(const TionState *)> &&callback) {
+  if (fields == dentra::tion::STATE_FIELD_ALL) {
+    this->add_on_state_callback(std::move(callback));
+    return;
+  }
+
+  this->state_subscribers_.push_back({.fields = fields, .epoch = 0, .callback = std::move(callback)});
+
+  // subscribers are added on setup only, so the index is just rebuilt
+  this->field_subscribers_.clear();
+  for (uint8_t bit = 0; bit < 32; bit++) {
+    this->field_index_[bit] = this->field_subscribers_.size();
+    for (size_t i = 0; i < this->state_subscribers_.size(); i++) {
+      if (this->state_subscribers_[i].fields & (1u << bit)) {
+        this->field_subscribers_.push_back(i);
+      }
+    }
+  }
+  this->field_index_[32] = this->field_subscribers_.size();
 }
 
 void TionApiComponent::state_check_schedule_() {
-  this->set_timeout(STATE_TIMEOUT, this->state_timeout_, [this]() {
-    // error reporting
-    if (this->status_has_error()) {
-      ESP_LOGW(TAG, "State was not received in %.1f s", this->state_timeout_ * 0.001f);
-    } else {
-      this->status_set_error(str_sprintf("State was not received in %.1f s", this->state_timeout_ * 0.001f).c_str());
+  this->set_timeout(STATE_TIMEOUT, this->state_timeout_, [this]() { this->state_lost_(); });
+}
+
+void TionApiComponent::state_lost_() {
+  // error reporting
+  if (this->status_has_error()) {
+    ESP_LOGW(TAG, "State was not received in %.1f s", this->state_timeout_ * 0.001f);
+  } else {
+    this->status_set_error(str_sprintf("State was not received in %.1f s", this->state_timeout_ * 0.001f).c_str());
+  }
+  // do not wait the backed off interval to find the breezer again
+  if (this->poll_max_interval_ != 0) {
+    this->poll_idle_ = 0;
+    this->poll_fast_ = 0;
+    this->poll_set_interval_(this->get_update_interval());
+  }
+  // notify subscribers
+  this->notify_state_(nullptr, dentra::tion::STATE_FIELD_ALL);
+}
+
+void TionApiComponent::poll_adapt_(uint32_t changes) {
+  if (this->poll_max_interval_ == 0) {
+    return;
+  }
+
+  const auto &state = this->state();
+  // counters are changed constantly while breezer is working
+  if (changes & ~dentra::tion::STATE_FIELD_COUNTERS) {
+    this->poll_idle_ = 0;
+    // auto mode is converging while it changes fan speed
+    const uint32_t auto_fields = dentra::tion::STATE_FIELD_FAN_SPEED | dentra::tion::STATE_FIELD_AUTO_SETTINGS;
+    if (state.auto_state && (changes & auto_fields)) {
+      this->poll_fast_ = FAST_POLLS;
     }
-    // notify subscribers
-    this->state_callback_.call(nullptr);
-  });
+  } else if (this->poll_idle_ < UINT8_MAX) {
+    this->poll_idle_++;
+  }
+
+  if (this->poll_fast_ > 0 || state.boost_time_left > 0) {
+    if (this->poll_fast_ > 0) {
+      this->poll_fast_--;
+    }
+    // back off starts after fast polls
+    this->poll_idle_ = 0;
+    this->poll_set_interval_(this->poll_min_interval_);
+    return;
+  }
+
+  uint32_t interval = this->get_update_interval();
+  for (auto n = this->poll_idle_ / IDLE_POLLS; n > 0 && interval < this->poll_max_interval_; n--) {
+    interval *= 2;
+  }
+  this->poll_set_interval_(std::min(interval, this->poll_max_interval_));
+}
+
+void TionApiComponent::poll_fast_start_() {
+  if (this->poll_max_interval_ == 0) {
+    return;
+  }
+  this->poll_idle_ = 0;
+  this->poll_fast_ = FAST_POLLS;
+  this->poll_set_interval_(this->poll_min_interval_);
 }
 
-dentra::tion::TionStateCall *TionApiComponent::make_call() {
-  const auto batch_start_time = this->batch_call_.get_start_time();
+void TionApiComponent::poll_set_interval_(uint32_t interval) {
+  if (interval == this->get_poll_interval()) {
+    return;
+  }
+  ESP_LOGD(TAG, "Poll interval: %.1f s", interval * 0.001f);
+  this->poll_interval_ = interval;
+  // replaces the interval started by PollingComponent
+  this->set_interval(UPDATE_INTERVAL, interval, [this]() { this->update(); });
+}
+
+dentra::tion::TionStateCall *TionApiComponent::make_call(bool final) {
+  const auto batch_start_time = this->batch_.get_start_time();
   if (batch_start_time != 0) {
     ESP_LOGD(TAG, "Continue batch update: %" PRIu32 " ms", millis() - batch_start_time);
   } else {
     ESP_LOGD(TAG, "Starting batch update: %" PRIu32 " ms", this->batch_timeout_);
   }
-  return &this->batch_call_;
+  this->batch_.set_final(final);
+  return &this->batch_;
+}
+
+#ifdef USE_TION_HISTORY_WEB
+
+bool TionHistoryHandler::canHandle(AsyncWebServerRequest *request) {
+  if (request->method() != HTTP_GET) {
+    return false;
+  }
+  return request->url() == this->csv_url_.c_str() || request->url() == this->bin_url_.c_str();
 }
 
+void TionHistoryHandler::handleRequest(AsyncWebServerRequest *request) {
+  const bool csv = request->url() == this->csv_url_.c_str();
+  auto *stream = request->beginResponseStream(csv ? "text/csv" : "application/octet-stream");
+  auto writer = [stream](const char *data, size_t size) {
+#ifdef USE_ARDUINO
+    stream->write(reinterpret_cast<const uint8_t *>(data), size);
+#else
+    stream->print(std::string(data, size));
+#endif
+  };
+  if (csv) {
+    this->history_->write_csv(writer);
+  } else {
+    this->history_->write_binary(writer);
+  }
+  request->send(stream);
+}
+
+#endif  // USE_TION_HISTORY_WEB
+
 #ifdef TION_ENABLE_SCHEDULER
 
 void Tion4sApiComponent::on_time(time_t time, uint32_t request_id) {
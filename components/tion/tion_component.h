@@ -2,6 +2,8 @@
 
 #include <functional>
 #include <map>
+#include <string>
+#include <vector>
 
 #include "esphome/core/defines.h"
 #include "esphome/core/log.h"
@@ -9,15 +11,37 @@
 #include "esphome/core/component.h"
 
 #include "../tion-api/tion-api.h"
+#include "../tion-api/latency_histogram.h"
 #include "../tion-api/tion-api-o2.h"
 #include "../tion-api/tion-api-3s.h"
 #include "../tion-api/tion-api-4s.h"
 #include "../tion-api/tion-api-lt.h"
 #include "tion_vport.h"
 
+#ifdef USE_TION_HISTORY_WEB
+#include "esphome/components/web_server_base/web_server_base.h"
+#endif
+
 namespace esphome {
 namespace tion {
 
+#ifdef USE_TION_HISTORY_WEB
+class TionHistoryHandler : public AsyncWebHandler {
+ public:
+  TionHistoryHandler(const dentra::tion::TionStateHistoryBase *history, const std::string &id)
+      : history_(history), csv_url_("/tion/" + id + "/history.csv"), bin_url_("/tion/" + id + "/history.bin") {}
+
+  bool canHandle(AsyncWebServerRequest *request) override;
+  void handleRequest(AsyncWebServerRequest *request) override;
+  bool isRequestHandlerTrivial() override { return false; }
+
+ protected:
+  const dentra::tion::TionStateHistoryBase *history_;
+  const std::string csv_url_;
+  const std::string bin_url_;
+};
+#endif
+
 class TionApiComponent : public PollingComponent {
  protected:
   using TionApiBase = dentra::tion::TionApiBase;
@@ -25,24 +49,53 @@ class TionApiComponent : public PollingComponent {
   using TionStateCall = dentra::tion::TionStateCall;
   using TionGatePosition = dentra::tion::TionGatePosition;
 
-  class BatchStateCall : public dentra::tion::TionStateCall {
+ public:
+  /// Latency of user changes [ms], from 25 ms to 6.4 s and more.
+  using LatencyHistogram = dentra::tion::LatencyHistogram<25, 10>;
+
+ protected:
+  /// Coalesces changes of several entities into a single write. Changes are merged per field and written
+  /// batch_timeout after the first one, at once when the batch is final, but not before the previous write
+  /// is confirmed by the breezer or state_timeout is passed.
+  class BatchCoalescer : public dentra::tion::TionStateCall {
    public:
-    explicit BatchStateCall(TionApiComponent *c) : dentra::tion::TionStateCall(c->api_), c_(c) {}
+    explicit BatchCoalescer(TionApiComponent *c) : dentra::tion::TionStateCall(c->api_), c_(c) {}
 
-    virtual ~BatchStateCall() {}
+    virtual ~BatchCoalescer() {}
 
     void perform() override;
 
+    /// Time of the first change of the batch or 0 if there are no changes.
     uint32_t get_start_time() const { return this->start_time_; };
+    /// Marks the next perform as final, so the batch is written at once if nobody else changed it.
+    void set_final(bool final) { this->final_ = final; }
+
+    /// Must be called on each state received from the breezer.
+    void on_state();
+
+    const LatencyHistogram &get_send_latency() const { return this->send_latency_; }
+    const LatencyHistogram &get_confirm_latency() const { return this->confirm_latency_; }
 
    protected:
     TionApiComponent *c_;
     uint32_t start_time_{};
-    void perform_();
+    // number of performs in the batch
+    uint8_t performs_{};
+    bool final_{};
+    // time of the first change of the written batch or 0 if it is confirmed
+    uint32_t confirm_start_time_{};
+    uint32_t sent_time_{};
+    LatencyHistogram send_latency_{};
+    LatencyHistogram confirm_latency_{};
+
+    void schedule_(uint32_t delay);
+    void flush_(bool force = false);
+    bool is_holding_() const;
+    void confirmed_();
   };
 
  public:
-  explicit TionApiComponent(TionApiBase *api) : api_(api), batch_call_(this) {
+  explicit TionApiComponent(TionApiBase *api) : api_(api), batch_(this) {
     api->on_state_fn.set<TionApiComponent, &TionApiComponent::on_state_>(*this);
   }
 
@@ -60,9 +113,29 @@ class TionApiComponent : public PollingComponent {
    * @param callback The callback to call.
    */
   void add_on_state_callback(std::function<void(const TionState *)> &&callback) {
+    this->state_callback_.add([callback = std::move(callback)](const TionState *state, uint32_t) { callback(state); });
+  }
+
+  /**
+   * Add a callback for the breezer state, each time the state of the device is updated, this callback will be called
+   * with a bitmask of dentra::tion::TionStateField changed since the previous call.
+   * When state is not returned in configured period - a callback called with nullptr and all fields changed.
+   *
+   * @param callback The callback to call.
+   */
+  void add_on_state_callback(std::function<void(const TionState *, uint32_t changes)> &&callback) {
     this->state_callback_.add(std::move(callback));
   }
 
+  /**
+   * Add a callback for the breezer state fields, it will be called only when any of the fields is changed.
+   * When state is not returned in configured period - a callback called with nullptr.
+   *
+   * @param fields Bitmask of dentra::tion::TionStateField the callback depends on.
+   * @param callback The callback to call.
+   */
+  void add_on_state_callback(uint32_t fields, std::function<void(const TionState *)> &&callback);
+
 #ifdef TION_ENABLE_API_CONTROL_CALLBACK
   /**
    * Add a callback for the breezer configuration, each time the configuration parameters of a device
@@ -79,11 +152,45 @@ class TionApiComponent : public PollingComponent {
   void set_batch_timeout(uint32_t batch_timeout) { this->batch_timeout_ = batch_timeout; };
   void set_force_update(bool force_update) { this->force_update_ = force_update; };
   bool get_force_update() const { return this->force_update_; }
+  void set_optimistic(bool optimistic) { this->api_->set_optimistic(optimistic); }
+  /// Tracker of the requests sent to the breezer. State timeout is reported as soon as the tracker
+  /// gives up the state request and lost link is reported as warning.
+  void set_request_tracker(dentra::tion::TionRequestTracker *requests);
+  /// Vport API wrapper providing the request tracker and the TX queue.
+  template<class vport_api_t> void set_vport_api(vport_api_t *api) {
+    this->tx_queue_ = &api->get_tx_queue();
+    this->set_request_tracker(api->get_request_tracker());
+  }
+  /// Enables adaptive polling. Breezer is polled with min_interval after writes, during boost and while auto mode
+  /// changes fan speed. Each IDLE_POLLS polls in a row without changes double update interval up to max_interval.
+  void set_adaptive_interval(uint32_t min_interval, uint32_t max_interval) {
+    this->poll_min_interval_ = min_interval;
+    this->poll_max_interval_ = max_interval;
+  }
+#ifdef USE_TION_HISTORY_WEB
+  /// Exposes state history at /tion/<id>/history.csv and /tion/<id>/history.bin.
+  void set_history_web(web_server_base::WebServerBase *base, const char *id) {
+    this->history_web_ = base;
+    this->history_web_id_ = id;
+  }
+#endif
+  /// Returns current poll interval in ms.
+  uint32_t get_poll_interval() const {
+    return this->poll_interval_ ? this->poll_interval_ : this->get_update_interval();
+  }
   void add_preset(const std::string &name, const TionApiBase::PresetData &preset) {
     this->api_->add_preset(name, preset);
   }
 
-  TionStateCall *make_call();
+  /// Returns call collecting changes into the batch.
+  /// @param final the call is the complete change of a single entity, the batch is written at once
+  /// if nobody else changed it.
+  TionStateCall *make_call(bool final = false);
+
+  /// Returns latency from the first change of the batch to its write.
+  const LatencyHistogram &get_send_latency() const { return this->batch_.get_send_latency(); }
+  /// Returns latency from the first change of the batch to its confirmation by the breezer.
+  const LatencyHistogram &get_confirm_latency() const { return this->batch_.get_confirm_latency(); }
 
   TionApiBase *api() { return this->api_; }
 
@@ -93,20 +200,66 @@ class TionApiComponent : public PollingComponent {
   const dentra::tion::TionState &state() const { return this->api_->get_state(); }
 
  protected:
+  enum {
+    // number of polls with min interval after a write
+    FAST_POLLS = 3,
+    // number of polls without changes to double the interval
+    IDLE_POLLS = 3,
+  };
+
   TionApiBase *api_;
+  const dentra::tion::TionRequestTracker *requests_{};
+  const dentra::tion::TionTxQueue *tx_queue_{};
+  // response type of the state request
+  uint16_t state_type_{};
   bool force_update_{};
-  BatchStateCall batch_call_;
+  BatchCoalescer batch_;
+
+  // adaptive polling is disabled when max interval is 0
+  uint32_t poll_min_interval_{};
+  uint32_t poll_max_interval_{};
+  uint32_t poll_interval_{};
+  uint8_t poll_fast_{};
+  uint8_t poll_idle_{};
+
+#ifdef USE_TION_HISTORY_WEB
+  web_server_base::WebServerBase *history_web_{};
+  const char *history_web_id_{};
+#endif
 
   uint32_t state_timeout_{};
   uint32_t batch_timeout_{};
+  // changes accumulated until deferred state notification
+  uint32_t state_changes_{};
+
+  CallbackManager<void(const TionState *, uint32_t)> state_callback_{};
 
-  CallbackManager<void(const TionState *)> state_callback_{};
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  struct state_subscriber_t {
+    uint32_t fields;
+    // last notification the subscriber was called for
+    uint32_t epoch;
+    std::function<void(const TionState *)> callback;
+  };
+  std::vector<state_subscriber_t> state_subscribers_;
+  // indexes of state_subscribers_ grouped by field bit,
+  // subscribers of bit N are in range [field_index_[N], field_index_[N + 1])
+  std::vector<uint16_t> field_subscribers_;
+  uint16_t field_index_[33]{};
+  uint32_t state_epoch_{};
+
+  void notify_state_(const TionState *state, uint32_t changes);
 #ifdef TION_ENABLE_API_CONTROL_CALLBACK
   CallbackManager<void(TionStateCall *)> control_callback_{};
 #endif
 
-  void on_state_(const TionState &state, const uint32_t request_id);
+  void on_state_(const TionState &state, uint32_t changes, uint32_t request_id);
   void state_check_schedule_();
+  void state_lost_();
+  void on_request_timeout_(uint16_t rsp_type, uint32_t request_id);
+  void poll_adapt_(uint32_t changes);
+  void poll_fast_start_();
+  void poll_set_interval_(uint32_t interval);
 };
 
 // T - TionApi implementation
@@ -114,7 +267,9 @@ template<class A> class TionApiComponentBase : public TionApiComponent {
  public:
   using Api = A;
 
-  explicit TionApiComponentBase(Api *api, TionVPortType /*vport_type*/) : TionApiComponent(api) {}
+  explicit TionApiComponentBase(Api *api, TionVPortType /*vport_type*/) : TionApiComponent(api) {
+    this->state_type_ = api->get_state_type();
+  }
 
  protected:
   Api *typed_api() { return reinterpret_cast<Api *>(this->api_); }
@@ -14,6 +14,7 @@ using dentra::tion::TionState;
 using dentra::tion::TionTraits;
 using dentra::tion::TionGatePosition;
 using dentra::tion::TionStateCall;
+using namespace dentra::tion;  // NOLINT(google-build-using-namespace): STATE_FIELD_* constants
 
 template<typename C> class Controller {
   constexpr static const auto *TAG = "tion_properties";
@@ -46,6 +47,10 @@ template<typename C> class Controller {
         -> std::enable_if_t<sizeof(decltype(T::get(c, {})) *) != 0, std::true_type>;
     template<typename T> std::false_type test_api_state_get(...);
 
+    template<typename T>
+    auto test_state_fields(int) -> std::enable_if_t<sizeof(decltype(T::STATE_FIELDS) *) != 0, std::true_type>;
+    template<typename T> std::false_type test_state_fields(...);
+
     template<typename T>
     auto test_icon_get(TionApiComponent *c)
         -> std::enable_if_t<sizeof(decltype(T::get_icon(c)) *) != 0, std::true_type>;
@@ -62,11 +67,22 @@ template<typename C> class Controller {
     constexpr bool has_api_set() { return !has_state_set() && !has_api_state_set(); }
 
     constexpr bool has_icon_get() { return decltype(test_icon_get<C>(TAC))::value; }
+
+    constexpr bool has_state_fields() { return decltype(test_state_fields<C>(0))::value; }
   };
 
  public:
   static constexpr Checker checker() { return Checker{}; }
 
+  /// Returns bitmask of TionStateField the property depends on, all fields if it is not declared.
+  static constexpr uint32_t state_fields() {
+    if constexpr (checker().has_state_fields()) {
+      return C::STATE_FIELDS;
+    } else {
+      return STATE_FIELD_ALL;
+    }
+  }
+
   template<typename T> static bool is_supported(T *component [[maybe_unused]]) {
     if constexpr (checker().has_is_supported()) {
       if (!C::is_supported(component->get_parent())) {
@@ -149,12 +165,16 @@ template<typename C> class Controller {
 
 namespace binary_sensor {
 struct Power {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_POWER;
+
   static const char *get_icon(TionApiComponent *c) { return c->state().power_state ? "mdi:power" : "mdi:power-off"; }
 
   static bool get(const TionState &state) { return state.power_state; }
 };
 
 struct Heater {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_HEATER;
+
   static const char *get_icon(TionApiComponent *c) {
     return c->state().heater_state ? "mdi:radiator" : "mdi:radiator-off";
   }
@@ -163,7 +183,9 @@ struct Heater {
 };
 
 struct Sound {
-  static bool is_supported(TionApiComponent *c) { return c->traits().supports_sound_state; }
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_SOUND;
+
+  static bool is_supported(TionApiComponent *c) { return c->traits().supports<FEATURE_SOUND_STATE>(); }
 
   static const char *get_icon(TionApiComponent *c) {
     return c->state().sound_state ? "mdi:volume-high" : "mdi:volume-mute";
@@ -173,7 +195,9 @@ struct Sound {
 };
 
 struct Led {
-  static bool is_supported(TionApiComponent *c) { return c->traits().supports_led_state; }
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_LED;
+
+  static bool is_supported(TionApiComponent *c) { return c->traits().supports<FEATURE_LED_STATE>(); }
 
   static const char *get_icon(TionApiComponent *c) { return c->state().led_state ? "mdi:led-on" : "mdi:led-off"; }
 
@@ -181,22 +205,31 @@ struct Led {
 };
 
 struct Auto {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_AUTO;
+
   static bool get(const TionState &state) { return state.auto_state; }
 };
 
 struct Filter {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_FILTER;
+
   static bool get(const TionState &state) { return state.filter_state; }
 };
 
 struct GateError {
-  static bool is_supported(TionApiComponent *c) { return c->traits().supports_gate_error; }
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_GATE_ERROR;
+
+  static bool is_supported(TionApiComponent *c) { return c->traits().supports<FEATURE_GATE_ERROR>(); }
 
   static bool get(const TionState &state) { return state.gate_error_state; }
 };
 
 struct Gate {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_GATE_POSITION;
+
   static const char *get_icon(TionApiComponent *c) {
-    if (c->traits().supports_gate_position_change_mixed && c->state().gate_position == TionGatePosition::MIXED) {
+    if (c->traits().supports<FEATURE_GATE_POSITION_CHANGE_MIXED>() &&
+        c->state().gate_position == TionGatePosition::MIXED) {
       return "mdi:valve";
     }
     return c->state().get_gate_state() ? "mdi:valve-open" : "mdi:valve-closed";
@@ -206,16 +239,24 @@ struct Gate {
 };
 
 struct Heating {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_HEATER | STATE_FIELD_HEATER_VAR |
+                                          STATE_FIELD_OUTDOOR_TEMPERATURE | STATE_FIELD_CURRENT_TEMPERATURE |
+                                          STATE_FIELD_TARGET_TEMPERATURE;
+
   static const char *get_icon(TionApiComponent *c) { return Heater::get_icon(c); }
 
   static bool get(TionApiComponent *c, const TionState &state) { return state.is_heating(c->traits()); }
 };
 
 struct Error {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_ERRORS;
+
   static bool get(const TionState &state) { return state.errors != 0; }
 };
 
 struct Boost {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_BOOST_TIME;
+
   static bool get(const TionState &state) { return state.boost_time_left > 0; }
 };
 
@@ -247,8 +288,11 @@ struct Auto : public binary_sensor::Auto {
 };
 
 struct Recirculation {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_GATE_POSITION;
+
   static bool is_supported(TionApiComponent *c) {
-    return c->traits().supports_gate_position_change || c->traits().supports_gate_position_change_mixed;
+    return c->traits().supports<FEATURE_GATE_POSITION_CHANGE>() ||
+           c->traits().supports<FEATURE_GATE_POSITION_CHANGE_MIXED>();
   }
 
   static const char *get_icon(TionApiComponent *c) { return binary_sensor::Gate::get_icon(c); }
@@ -259,7 +303,7 @@ struct Recirculation {
 
 struct Boost : public binary_sensor::Boost {
   static void set(TionApiComponent *c, bool state) {
-    auto call = c->make_call();
+    auto call = c->make_call(true);
     c->api()->enable_boost(state, call);
     call->perform();
   }
@@ -269,6 +313,8 @@ struct Boost : public binary_sensor::Boost {
 
 namespace sensor {
 struct FanSpeed {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_POWER | STATE_FIELD_FAN_SPEED;
+
   static const char *get_icon(TionApiComponent *c) {
     if (!c->state().power_state) {
       return "mdi:fan-off";
@@ -295,44 +341,62 @@ struct FanSpeed {
 };
 
 struct OutdoorTemperature {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_OUTDOOR_TEMPERATURE;
+
   static int8_t get(const TionState &state) { return state.outdoor_temperature; }
 };
 
 struct CurrentTemperature {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_CURRENT_TEMPERATURE;
+
   static int8_t get(const TionState &state) { return state.current_temperature; }
 };
 
 struct TargetTemperature {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_TARGET_TEMPERATURE;
+
   static constexpr int8_t get(const TionState &state) { return state.target_temperature; }
 };
 
 struct Productivity {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_PRODUCTIVITY;
+
   static uint8_t get(const TionState &state) { return state.productivity; }
 };
 
 struct HeaterVar {
-  static bool is_supported(TionApiComponent *c) { return c->traits().supports_heater_var; }
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_HEATER_VAR;
+
+  static bool is_supported(TionApiComponent *c) { return c->traits().supports<FEATURE_HEATER_VAR>(); }
 
   static uint8_t get(const TionState &state) { return state.heater_var; }
 };
 
 struct HeaterPower {
+  static constexpr uint32_t STATE_FIELDS = binary_sensor::Heating::STATE_FIELDS;
+
   static float get(TionApiComponent *c, const TionState &state) { return state.get_heater_power(c->traits()); }
 };
 
 struct WorkTime {
-  static bool is_supported(TionApiComponent *c) { return c->traits().supports_work_time; }
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_WORK_TIME;
+
+  static bool is_supported(TionApiComponent *c) { return c->traits().supports<FEATURE_WORK_TIME>(); }
 
   static uint32_t get(const TionState &state) { return state.work_time; }
 };
 
 struct WorkTimeDays {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_WORK_TIME;
+
   static bool is_supported(TionApiComponent *c) { return WorkTime::is_supported(c); }
 
   static uint32_t get(const TionState &state) { return WorkTime::get(state) / (24 * 3600); }
 };
 
 struct FilterTimeLeft {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_FILTER_TIME;
+
   static const char *get_icon(TionApiComponent *c) {
     return binary_sensor::Filter::get(c->state()) ? "mdi:filter-remove" : "mdi:filter-check";
   }
@@ -340,57 +404,77 @@ struct FilterTimeLeft {
 };
 
 struct FilterTimeLeftDays {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_FILTER_TIME;
+
   static const char *get_icon(TionApiComponent *c) { return FilterTimeLeft::get_icon(c); }
   static uint32_t get(const TionState &state) { return FilterTimeLeft::get(state) / (24 * 3600); }
 };
 
 struct FanTime {
-  static bool is_supported(TionApiComponent *c) { return c->traits().supports_fan_time; }
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_FAN_TIME;
+
+  static bool is_supported(TionApiComponent *c) { return c->traits().supports<FEATURE_FAN_TIME>(); }
 
   static uint32_t get(const TionState &state) { return state.fan_time; }
 };
 
 struct FanTimeDays {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_FAN_TIME;
+
   static bool is_supported(TionApiComponent *c) { return FanTime::is_supported(c); }
 
   static uint32_t get(const TionState &state) { return FanTime::get(state) / (24 * 3600); }
 };
 
 struct Airflow {
-  static bool is_supported(TionApiComponent *c) { return c->traits().supports_airflow_counter; }
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_AIRFLOW;
+
+  static bool is_supported(TionApiComponent *c) { return c->traits().supports<FEATURE_AIRFLOW_COUNTER>(); }
 
   static float get(const TionState &state) { return state.airflow_m3; }
 };
 
 struct AirflowCounter {
-  static bool is_supported(TionApiComponent *c) { return c->traits().supports_airflow_counter; }
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_AIRFLOW;
+
+  static bool is_supported(TionApiComponent *c) { return c->traits().supports<FEATURE_AIRFLOW_COUNTER>(); }
 
   static uint32_t get(const TionState &state) { return state.airflow_counter; }
 };
 
 struct PcbCtlTemperature {
-  static bool is_supported(TionApiComponent *c) { return c->traits().supports_pcb_ctl_temperatire; }
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_PCB_CTL_TEMPERATURE;
+
+  static bool is_supported(TionApiComponent *c) { return c->traits().supports<FEATURE_PCB_CTL_TEMPERATURE>(); }
 
   static int8_t get(const TionState &state) { return state.pcb_ctl_temperature; }
 };
 
 struct PcbPwrTemperature {
-  static bool is_supported(TionApiComponent *c) { return c->traits().supports_pcb_pwr_temperature; }
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_PCB_PWR_TEMPERATURE;
+
+  static bool is_supported(TionApiComponent *c) { return c->traits().supports<FEATURE_PCB_PWR_TEMPERATURE>(); }
 
   static int8_t get(const TionState &state) { return state.pcb_pwr_temperature; }
 };
 
 struct BoostTimeLeft {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_BOOST_TIME;
+
   static float get(const TionState &state) { return state.boost_time_left > 0 ? state.boost_time_left : 0; }
 };
 
 struct FanPower {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_POWER | STATE_FIELD_FAN_SPEED;
+
   static float get(TionApiComponent *c, const TionState &state) {
     return c->traits().get_max_fan_power(state.power_state ? state.fan_speed : 0);
   }
 };
 
 struct Power {
+  static constexpr uint32_t STATE_FIELDS = FanPower::STATE_FIELDS | HeaterPower::STATE_FIELDS;
+
   static float get(TionApiComponent *c, const TionState &state) {
     return (FanPower::get(c, state) + HeaterPower::get(c, state)) * 0.001;
   }
@@ -419,6 +503,8 @@ struct FanSpeed : public sensor::FanSpeed {
 };
 
 struct AutoMinFanSpeed {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_AUTO_SETTINGS;
+
   static uint8_t get(TionApiComponent *c) { return c->api()->get_auto_min_fan_speed(); }
   static void set(TionApiComponent *c, uint8_t state) { c->api()->set_auto_min_fan_speed(state); }
   static constexpr uint8_t get_min(TionApiComponent *c) { return 0; }
@@ -426,6 +512,8 @@ struct AutoMinFanSpeed {
 };
 
 struct AutoMaxFanSpeed {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_AUTO_SETTINGS;
+
   static uint8_t get(TionApiComponent *c) { return c->api()->get_auto_max_fan_speed(); }
   static void set(TionApiComponent *c, uint8_t state) { c->api()->set_auto_max_fan_speed(state); }
   static constexpr uint8_t get_min(TionApiComponent *c) { return 1; }
@@ -433,6 +521,8 @@ struct AutoMaxFanSpeed {
 };
 
 struct AutoSetpoint {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_AUTO_SETTINGS;
+
   static uint16_t get(TionApiComponent *c) { return c->api()->get_auto_setpoint(); }
   static void set(TionApiComponent *c, uint16_t state) { c->api()->set_auto_setpoint(state); }
   static constexpr uint16_t get_min(TionApiComponent *c) { return 500; }
@@ -459,12 +549,16 @@ struct BoostTime {
 namespace text_sensor {
 
 struct Errors {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_ERRORS;
+
   static std::string get(TionApiComponent *c, const TionState &state) {
     return c->traits().errors_decoder(state.errors);
   };
 };
 
 struct FirmwareVersion {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_VERSION;
+
   static std::string get(const TionState &state) {
     if (!state.firmware_version) {
       return {};
@@ -474,6 +568,8 @@ struct FirmwareVersion {
 };
 
 struct HardwareVersion {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_VERSION;
+
   static std::string get(const TionState &state) {
     if (!state.hardware_version) {
       return {};
@@ -487,11 +583,13 @@ struct HardwareVersion {
 namespace select {
 
 struct AirIntake {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_GATE_POSITION;
+
   static std::vector<std::string> get_options(TionApiComponent *c) {
-    if (c->traits().supports_gate_position_change_mixed) {
+    if (c->traits().supports<FEATURE_GATE_POSITION_CHANGE_MIXED>()) {
       return {"outdoor", "indoor", "mixed"};
     }
-    if (c->traits().supports_gate_position_change) {
+    if (c->traits().supports<FEATURE_GATE_POSITION_CHANGE>()) {
       return {"inflow", "recirculation"};
     }
     return {};
@@ -514,14 +612,19 @@ struct AirIntake {
 };
 
 struct Presets {
+  static constexpr uint32_t STATE_FIELDS = STATE_FIELD_PRESET;
+
   static std::vector<std::string> get_options(TionApiComponent *c) {
-    if (c->api()->has_presets()) {
-      const auto presets = c->api()->get_presets();
-      std::vector<std::string> result(presets.size());
-      std::copy(presets.begin(), presets.end(), result.begin());
-      return result;
+    const auto *api = c->api();
+    if (!api->has_presets()) {
+      return {};
     }
-    return {};
+    std::vector<std::string> result;
+    result.reserve(api->get_presets_size());
+    for (uint8_t id = 0; id < api->get_presets_size(); id++) {
+      result.push_back(api->get_preset_name(id));
+    }
+    return result;
   };
   static std::string get(TionApiComponent *c) { return c->api()->get_active_preset(); }
   static void set(TionApiComponent *c, TionStateCall *call, const std::string &preset) {
@@ -534,7 +637,7 @@ struct Presets {
 namespace button {
 
 struct ResetFilter {
-  static bool is_supported(TionApiComponent *c) { return c->traits().supports_reset_filter; }
+  static bool is_supported(TionApiComponent *c) { return c->traits().supports<FEATURE_RESET_FILTER>(); }
 
   static void press_action(TionApiComponent *c) { c->api()->reset_filter(); }
 };
@@ -1,12 +1,16 @@
 #pragma once
+#include <cinttypes>
 #include <type_traits>
 
 #include "esphome/core/application.h"
 #include "esphome/core/defines.h"
+#include "esphome/core/log.h"
 
 #include "esphome/components/vport/vport.h"
 
 #include "../tion-api/tion-api-protocol.h"
+#include "../tion-api/tion-api-tx-queue.h"
+#include "../tion-api/tion-api-request-tracker.h"
 #include "../tion-api/tion-api-writer.h"
 
 namespace esphome {
@@ -14,6 +18,15 @@ namespace tion {
 
 enum TionVPortType : uint8_t { VPORT_UNKNOWN = 0, VPORT_BLE, VPORT_UART, VPORT_JTAG, VPORT_TCP };
 
+inline void dump_tx_queue(const char *tag, const dentra::tion::TionTxQueue &tx_queue) {
+  const auto &stats = tx_queue.get_tx_stats();
+  ESP_LOGCONFIG(tag, "  TX queue: %" PRIu32 " sent, %" PRIu32 " timeouts, max %" PRIu32 " queued, window %u",
+                stats.sent, stats.timeouts, stats.max_queued, tx_queue.get_window());
+  ESP_LOGCONFIG(tag, "  TX dropped: %" PRIu32 " coalesced, %" PRIu32 " deduped, %" PRIu32 " overflowed",
+                stats.coalesced, stats.deduped, stats.overflowed);
+  ESP_LOGCONFIG(tag, "  TX rejected: %" PRIu32, stats.rejected);
+}
+
 template<class protocol_type> class TionIO {
   static_assert(std::is_base_of_v<dentra::tion::TionProtocol<typename protocol_type::frame_spec_type>, protocol_type>,
                 "protocol_type must derived from dentra::tion::TionProtocol class");
@@ -28,33 +41,134 @@ template<class protocol_type> class TionIO {
 
   void set_on_frame(on_frame_type &&reader) { protocol_.reader = std::move(reader); }
 
+  /// Returns frame in the protocol TX buffer or nullptr if the protocol does not support it.
+  frame_spec_type *lease_frame(size_t data_size) { return this->protocol_.lease_frame(data_size); }
+
  protected:
   protocol_type protocol_;
 };
 
+template<class T, class = void> struct has_lease_frame : std::false_type {};
+template<class T>
+struct has_lease_frame<T, std::void_t<decltype(std::declval<T &>().lease_frame(size_t{}))>> : std::true_type {};
+
+template<class T, class = void> struct has_tx_policy : std::false_type {};
+template<class T> struct has_tx_policy<T, std::void_t<decltype(&T::get_tx_policy)>> : std::true_type {};
+
+template<class T, class = void> struct has_set_tx_policy : std::false_type {};
+template<class T>
+struct has_set_tx_policy<T, std::void_t<decltype(std::declval<T &>().set_tx_policy(
+                                dentra::tion::TionTxQueue::policy_type{}))>> : std::true_type {};
+
+template<class T, class = void> struct has_poll : std::false_type {};
+template<class T> struct has_poll<T, std::void_t<decltype(&T::get_poll)>> : std::true_type {};
+
+template<class T, class = void> struct has_request_info : std::false_type {};
+template<class T> struct has_request_info<T, std::void_t<decltype(&T::get_request_info)>> : std::true_type {};
+
+template<class T, class = void> struct has_response_id : std::false_type {};
+template<class T> struct has_response_id<T, std::void_t<decltype(&T::get_response_id)>> : std::true_type {};
+
 // vport wrapper with api support.
 template<class frame_spec_t, class api_t> class TionVPortApi : public api_t, public vport::VPortListener<frame_spec_t> {
   static_assert(std::is_base_of_v<dentra::tion::TionApiWriter, api_t>, "api_t is not TionApiWriter");
 
  public:
   using vport_t = vport::VPort<frame_spec_t>;
+  using lease_type = etl::delegate<frame_spec_t *(size_t data_size)>;
 
   TionVPortApi(vport_t *vport) : vport_(vport) {
     vport->add_listener(this);
     using this_t = std::remove_pointer_t<decltype(this)>;
     api_t::set_writer(api_t::writer_type::template create<this_t, &this_t::write_frame_>(*this));
+    this->tx_queue_.set_writer(dentra::tion::TionTxQueue::writer_type::create<this_t, &this_t::send_frame_>(*this));
+    if constexpr (has_tx_policy<api_t>::value) {
+      this->tx_queue_.set_policy(api_t::get_tx_policy);
+    }
+    if constexpr (has_poll<api_t>::value) {
+      // poll sub-requests in flight must not be held by the queue
+      this->tx_queue_.set_window(this->get_poll().get_window());
+    }
+    this->requests_.set_writer(
+        dentra::tion::TionRequestTracker::writer_type::create<this_t, &this_t::transmit_frame_>(*this));
+    if constexpr (has_request_info<api_t>::value) {
+      this->requests_.set_request_info(api_t::get_request_info);
+    }
+    if constexpr (has_response_id<api_t>::value) {
+      this->requests_.set_response_id(api_t::get_response_id);
+    }
+  }
+
+  /// Builds frames in place in the vport TX buffer and shares TX policy, when vport supports it.
+  template<class vport_impl_t, std::enable_if_t<std::is_base_of_v<vport_t, vport_impl_t>, bool> = true>
+  TionVPortApi(vport_impl_t *vport) : TionVPortApi(static_cast<vport_t *>(vport)) {
+    if constexpr (has_lease_frame<vport_impl_t>::value) {
+      using this_t = std::remove_pointer_t<decltype(this)>;
+      this->lease_ = lease_type::template create<vport_impl_t, &vport_impl_t::lease_frame>(*vport);
+      api_t::set_lease(api_t::lease_type::template create<this_t, &this_t::lease_frame_>(*this));
+    }
+    if constexpr (has_set_tx_policy<vport_impl_t>::value && has_tx_policy<api_t>::value) {
+      // half-duplex vport merges superseded frames of the api too
+      vport->set_tx_policy(api_t::get_tx_policy);
+    }
   }
 
   void on_ready() override { this->on_ready_fn.call_if(); }
 
   void on_frame(const frame_spec_t &frame, size_t size) override {
-    this->read_frame(frame.type, frame.data, size - frame_spec_t::head_size());
+    const size_t data_size = size - frame_spec_t::head_size();
+    this->requests_.complete(frame.type, frame.data, data_size);
+    this->read_frame(frame.type, frame.data, data_size);
+    // any received frame is treated as a response to the pending one
+    this->tx_queue_.on_frame();
   }
 
+  void loop() override {
+    api_t::loop();
+    this->requests_.loop();
+    this->tx_queue_.loop();
+  }
+
+  /// Sets number of poll sub-requests waiting for a response, the TX queue lets the same number of frames out.
+  template<class T = api_t, std::enable_if_t<has_poll<T>::value, bool> = true> void set_poll_window(uint8_t window) {
+    api_t::set_poll_window(window);
+    this->tx_queue_.set_window(this->get_poll().get_window());
+  }
+
+  const dentra::tion::TionTxQueue &get_tx_queue() const { return this->tx_queue_; }
+  const dentra::tion::TionRequestTracker &get_requests() const { return this->requests_; }
+  dentra::tion::TionRequestTracker *get_request_tracker() { return &this->requests_; }
+
  protected:
   vport_t *vport_;
+  lease_type lease_{};
+  dentra::tion::TionTxQueue tx_queue_;
+  dentra::tion::TionRequestTracker requests_;
+
+  void *lease_frame_(size_t size) {
+    auto *frame = this->lease_(size);
+    return frame ? frame->data : nullptr;
+  }
 
   bool write_frame_(uint16_t type, const void *data, size_t size) {
+    return this->tx_queue_.write(type, data, size);
+  }
+
+  bool send_frame_(uint16_t type, const void *data, size_t size) {
+    this->requests_.track(type, data, size);
+    return this->transmit_frame_(type, data, size);
+  }
+
+  bool transmit_frame_(uint16_t type, const void *data, size_t size) {
+    if (this->lease_ && size > 0) {
+      auto *frame = this->lease_(size);
+      if (frame != nullptr && data == frame->data) {
+        // frame data was built in place, no copy required
+        frame->type = type;
+        this->vport_->write(*frame, frame_spec_t::head_size() + size);
+        return true;
+      }
+    }
     uint8_t buf[sizeof(frame_spec_t) + size];
     std::memset(buf, 0, sizeof(buf));
     auto frame = reinterpret_cast<frame_spec_t *>(buf);
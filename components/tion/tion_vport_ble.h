@@ -10,6 +10,20 @@ namespace tion {
 
 #define TION_VPORT_BLE_LOG(port_name) VPORT_BLE_LOG(port_name);
 
+namespace ble_mtu {
+// Negotiated ATT MTU of the node's BLE client, 23 when it is not available.
+template<class T> auto get(T *node, int) -> decltype(uint16_t(node->parent()->get_mtu())) {
+  return node->parent()->get_mtu();
+}
+template<class T> uint16_t get(T * /*node*/, long) { return 23; }  // NOLINT(google-runtime-int)
+
+// Passes ATT MTU to the protocol, when it supports it.
+template<class T> auto set(T &protocol, uint16_t mtu, int) -> decltype(protocol.set_mtu(mtu)) {
+  return protocol.set_mtu(mtu);
+}
+template<class T> void set(T & /*protocol*/, uint16_t /*mtu*/, long) {}  // NOLINT(google-runtime-int)
+}  // namespace ble_mtu
+
 template<class protocol_type> class TionBleIO : public TionIO<protocol_type>, public vport::VPortBLENode {
  public:
   using frame_spec_type = typename protocol_type::frame_spec_type;
@@ -26,7 +40,10 @@ template<class protocol_type> class TionBleIO : public TionIO<protocol_type>, pu
 
   void set_on_ready(on_ready_type &&on_ready) { this->on_ready_ = on_ready; }
 
-  void on_ble_ready() override { this->on_ready_.call_if(); }
+  void on_ble_ready() override {
+    ble_mtu::set(this->protocol_, ble_mtu::get(this, 0), 0);
+    this->on_ready_.call_if();
+  }
   bool on_ble_data(const uint8_t *data, uint16_t size) override { return this->protocol_.read_data(data, size); }
 
  protected:
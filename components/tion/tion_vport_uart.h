@@ -4,7 +4,9 @@
 
 #ifdef USE_TION_HALF_DUPLEX
 // #pragma message("USE_TION_HALF_DUPLEX")
+#include <cstring>
 #include "esphome/core/application.h"
+#include "../tion-api/tion-api-tx-queue.h"
 #endif
 
 #include "esphome/components/uart/uart_component.h"
@@ -49,40 +51,60 @@ class TionVPortUARTComponent : public vport::VPortUARTComponent<io_t, typename i
 #ifdef USE_TION_HALF_DUPLEX
     using this_t = typename std::remove_pointer_t<decltype(this)>;
     this->io_->set_on_frame(io_t::on_frame_type::template create<this_t, &this_t::on_frame_>(*this));
+    this->tx_queue_.set_writer(dentra::tion::TionTxQueue::writer_type::create<this_t, &this_t::send_frame_>(*this));
+    this->tx_queue_.set_half_duplex(true);
 #endif
   }
 
   TionVPortType get_type() const { return TionVPortType::VPORT_UART; }
 
+  typename io_t::frame_spec_type *lease_frame(size_t data_size) { return this->io_->lease_frame(data_size); }
+
 #ifdef USE_TION_HALF_DUPLEX
   void write(const typename io_t::frame_spec_type &frame, size_t size) override {
-    if (this->await_frame_) {
-      auto data8 = reinterpret_cast<const uint8_t *>(&frame);
-      auto datav = std::vector<uint8_t>(data8, data8 + size);
-      this->defer([this, datav]() {
-        auto frame = reinterpret_cast<const typename io_t::frame_spec_type *>(datav.data());
-        if (this->await_frame_) {
-          ESP_LOGW("tion_vport_uart", "prev frame was not recv, may lead to crash");
-        }
-        super_t::write(*frame, datav.size());
-        arch_feed_wdt();
-        yield();
-      });
+    this->tx_queue_.write(frame.type, frame.data, size - io_t::frame_spec_type::head_size());
+  }
+
+  void loop() override {
+    super_t::loop();
+    this->tx_queue_.loop();
+  }
+
+  /// Sets policy used to merge superseded frames waiting for transmission.
+  void set_tx_policy(dentra::tion::TionTxQueue::policy_type policy) { this->tx_queue_.set_policy(policy); }
+
+  const dentra::tion::TionTxQueue &get_tx_queue() const { return this->tx_queue_; }
+
+ protected:
+  // frames are sent one by one, the next one when a response is received or an ack timeout fires
+  dentra::tion::TionTxQueue tx_queue_;
+
+  bool send_frame_(uint16_t type, const void *data, size_t size) {
+    using frame_spec_t = typename io_t::frame_spec_type;
+    auto *frame = this->io_->lease_frame(size);
+    if (frame != nullptr) {
+      frame->type = type;
+      // data could be already built in place
+      std::memmove(frame->data, data, size);
+      super_t::write(*frame, frame_spec_t::head_size() + size);
     } else {
-      this->await_frame_ = true;
-      super_t::write(frame, size);
-      arch_feed_wdt();
-      yield();
+      uint8_t buf[sizeof(frame_spec_t) + size];
+      std::memset(buf, 0, sizeof(buf));
+      frame = reinterpret_cast<frame_spec_t *>(buf);
+      frame->type = type;
+      std::memcpy(frame->data, data, size);
+      super_t::write(*frame, sizeof(buf));
     }
+    arch_feed_wdt();
+    yield();
+    return true;
   }
 
- protected:
-  bool await_frame_{};
   void on_frame_(const typename io_t::frame_spec_type &frame, size_t size) {
     arch_feed_wdt();
     yield();
-    this->await_frame_ = false;
     this->fire_frame(frame, size);
+    this->tx_queue_.on_frame();
   }
 #endif
 };
@@ -24,6 +24,8 @@ CONFIG_SCHEMA = (
 
 async def to_code(config):
     _, api = await tion.new_vport_api_wrapper(config, Tion3sApiProxy)
+    # proxy api has no model traits
+    cg.add_build_flag("-DTION_DYNAMIC_TRAITS")
     urt = await cg.get_variable(config[uart.CONF_UART_ID])
     ble = cg.new_Pvariable(config[CONF_ID], api, urt)
     await cg.register_component(ble, config)
@@ -7,7 +7,12 @@ namespace tion {
 
 static const char *const TAG = "tion_3s_uart_vport";
 
-void Tion3sUartVPort::dump_config() { VPORT_UART_LOG("Tion 3S UART"); }
+void Tion3sUartVPort::dump_config() {
+  VPORT_UART_LOG("Tion 3S UART");
+#ifdef USE_TION_HALF_DUPLEX
+  dump_tx_queue(TAG, this->tx_queue_);
+#endif
+}
 
 }  // namespace tion
 }  // namespace esphome
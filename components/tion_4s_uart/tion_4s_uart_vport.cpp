@@ -15,6 +15,9 @@ static const char *const TAG = "tion_4s_uart_vport";
 void Tion4sUartVPort::dump_config() {
   VPORT_UART_LOG("Tion 4S UART");
   ESP_LOGCONFIG(TAG, "  Heartbeat Interval: %.1f s", this->heartbeat_interval_ * 0.001f);
+#ifdef USE_TION_HALF_DUPLEX
+  dump_tx_queue(TAG, this->tx_queue_);
+#endif
 }
 
 void Tion4sUartVPort::setup() {
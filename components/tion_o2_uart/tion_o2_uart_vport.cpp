@@ -8,7 +8,12 @@ namespace tion {
 
 static const char *const TAG = "tion_o2_uart_vport";
 
-void TionO2UartVPort::dump_config() { VPORT_UART_LOG("Tion O2 UART"); }
+void TionO2UartVPort::dump_config() {
+  VPORT_UART_LOG("Tion O2 UART");
+#ifdef USE_TION_HALF_DUPLEX
+  dump_tx_queue(TAG, this->tx_queue_);
+#endif
+}
 
 }  // namespace tion
 }  // namespace esphome
@@ -8,7 +8,6 @@
 
 #ifdef TION_UPDATE_EMU
 #include "../tion-api/tion-api-firmware.h"
-#include "../tion-api/crc.h"
 #endif
 
 namespace esphome {
@@ -271,7 +270,7 @@ void Tion4sRC::on_frame(uint16_t type, const uint8_t *data, size_t size) {
       this->is_update_ = true;
       this->fw_size_ = 0;
       this->fw_load_ = 0;
-      this->fw_crc_ = 0xFFFF;
+      this->fw_crc_.reset();
 
       this->pr_.write_frame(FRAME_TYPE_UPDATE_PREPARE_RSP, &rsp, sizeof(rsp));
       break;
@@ -322,8 +321,7 @@ void Tion4sRC::on_frame(uint16_t type, const uint8_t *data, size_t size) {
           break;
         }
         ESP_LOGI(TAG, "Got final chunk at %" PRIu32, req->offset);
-        this->fw_crc_ = crc16_ccitt_false(this->fw_crc_, req->data, chunk_size);
-        if (this->fw_crc_ != 0) {
+        if (this->fw_crc_.update(req->data, chunk_size).value() != 0) {
           ESP_LOGW(TAG, "CRC failed");
           this->pr_.write_frame(FRAME_TYPE_UPDATE_ERROR, nullptr, 0);
           break;
@@ -346,7 +344,7 @@ void Tion4sRC::on_frame(uint16_t type, const uint8_t *data, size_t size) {
           break;
         }
 
-        this->fw_crc_ = crc16_ccitt_false(this->fw_crc_, req->data, chunk_size);
+        this->fw_crc_.update(req->data, chunk_size);
       }
 
       this->pr_.write_frame(FRAME_TYPE_UPDATE_CHUNK_RSP, nullptr, 0);
@@ -2,6 +2,9 @@
 
 #include "tion_rc.h"
 #include "../tion-api/tion-api-ble-lt.h"
+#ifdef TION_UPDATE_EMU
+#include "../tion-api/crc.h"
+#endif
 
 namespace esphome {
 namespace tion_rc {
@@ -23,7 +26,7 @@ class Tion4sRC : public TionRCControlImpl<Tion4sRCBleProtocol> {
   bool is_update_{};
   uint32_t fw_size_{};
   uint32_t fw_load_{};
-  uint16_t fw_crc_{};
+  dentra::tion::Crc16Ccitt fw_crc_{};
 #endif
 };
 
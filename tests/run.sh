@@ -20,9 +20,12 @@ DEFS=(
   TION_ENABLE_HEARTBEAT
   TION_ENABLE_SCHEDULER
   TION_ENABLE_DIAGNOSTIC
+  TION_ENABLE_HISTORY
   USE_VPORT_UART
   USE_VPORT_BLE
   USE_VPORT_COMMAND_QUEUE_SIZE=16
+  # uncomment to run timing benchmarks
+  # TION_ENABLE_BENCH
 )
 
 LIB_DIR=$WORKSPACE_DIR/lib
@@ -13,6 +13,11 @@ class TestTionApiBase : public dentra::tion::TionApiBase {
   void request_state() override { ESP_LOGE(TAG, "request_state is not implemented."); }
   void write_state(dentra::tion::TionStateCall *call) override { ESP_LOGE(TAG, "write_state is not implemented."); }
   void reset_filter() override { ESP_LOGE(TAG, "reset_filter is not implemented."); }
+
+  void test_update_state(const TionState &state) {
+    this->state_ = state;
+    this->notify_state_(0);
+  }
 };
 
 class ApiTest {
@@ -91,4 +96,36 @@ bool test_api() {
   return res;
 }
 
+static uint32_t changes;
+static void on_state_changes(const TionState &, uint32_t state_changes, uint32_t) { changes = state_changes; }
+
+bool test_api_state_changes() {
+  bool res = true;
+
+  TestTionApiBase api;
+  api.on_state_fn.set<on_state_changes>();
+
+  TionState state{};
+  state.fan_speed = 2;
+  state.work_time = 100;
+  api.test_update_state(state);
+  res &= cloak::check_data("first", changes, uint32_t(STATE_FIELD_ALL));
+
+  api.test_update_state(state);
+  res &= cloak::check_data("same", changes, 0u);
+
+  state.work_time = 101;
+  state.airflow_m3 = 1.5f;
+  api.test_update_state(state);
+  res &= cloak::check_data("counters", changes, uint32_t(STATE_FIELD_WORK_TIME | STATE_FIELD_AIRFLOW));
+
+  state.power_state = true;
+  state.fan_speed = 3;
+  api.test_update_state(state);
+  res &= cloak::check_data("power", changes, uint32_t(STATE_FIELD_POWER | STATE_FIELD_FAN_SPEED));
+
+  return res;
+}
+
 REGISTER_TEST(test_api);
+REGISTER_TEST(test_api_state_changes);
@@ -5,6 +5,8 @@
 #include <string>
 #include "../components/tion-api/tion-api-ble-lt.h"
 #include "../components/tion-api/tion-api-ble-3s.h"
+#include "../components/tion-api/tion-api-tx-queue.h"
+#include "esphome/core/helpers.h"
 
 class TestTionLtBleProtocol : public dentra::tion::TionLtBleProtocol {
  public:
@@ -20,6 +22,12 @@ class TestTion3sBleProtocol : public dentra::tion::Tion3sBleProtocol {
   }
 };
 
+/// Expires the response awaited by the TX queue, so the next frame is sent immediately.
+template<class api_t> void skip_tx_response(api_t &api) {
+  esphome::test_set_millis(esphome::millis() + dentra::tion::TionTxQueue::RESPONSE_TIMEOUT);
+  api.loop();
+}
+
 template<class api_t> class TionComponentTest {
  public:
   using api_type = api_t;
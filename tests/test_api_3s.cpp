@@ -72,6 +72,7 @@ bool test_api_3s() {
   api.request_state();
   vport.call_loop();
   res &= cloak::check_data("request_state", io, "3D.01.00.00.00.00.00.00.00.00.00.00.00.00.00.00.00.00.00.5A");
+  skip_tx_response(api);
 
   api.st().firmware_version = 0xFFFF;
   api.st().fan_speed = 1;
@@ -79,10 +80,12 @@ bool test_api_3s() {
   api.write_state(api.st());
   vport.call_loop();
   res &= cloak::check_data("write_state empty", io, "3D.02.01.00.00.00.01.00.00.00.00.00.00.00.00.00.00.00.00.5A");
+  skip_tx_response(api);
 
   api.reset_filter();
   vport.call_loop();
   res &= cloak::check_data("reset_filter", io, "3D.02.01.00.00.00.01.02.00.00.00.00.00.00.00.00.00.00.00.5A");
+  skip_tx_response(api);
 
   api.st().fan_speed = 1;
   api.st().heater_state = true;
@@ -179,6 +182,7 @@ bool test_uart_3s() {
   api.request_state();
   vport.call_loop();
   res &= cloak::check_data("request_state data", uart, "3D.01.00.00.00.00.00.00.00.00.00.00.00.00.00.00.00.00.00.5A");
+  skip_tx_response(api);
 
   api.st().heater_state = false;
   printf("0x%04X\n", api.st().filter_time_left);
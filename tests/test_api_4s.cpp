@@ -68,7 +68,7 @@ class Tion4sUartVPortApiTest : public Tion4sUartVPortApiTestBase {
       this->state_.sound_state = req->data.sound_state;
       // add others
 
-      this->on_state_fn(this->state_, req->request_id);
+      this->on_state_fn(this->state_, dentra::tion::STATE_FIELD_ALL, req->request_id);
     }
     return this->write_frame_(type, data, size);
   }
@@ -131,10 +131,12 @@ bool test_api_4s() {
   api.request_state();
   vport.call_loop();
   res &= cloak::check_data("request_state", io, "80.0C.00.3A.AD 32.32 01.00.00.00 64.F7");
+  skip_tx_response(api);
 
   api.request_dev_info();
   vport.call_loop();
   res &= cloak::check_data("request_dev_info", io, "80.0C.00.3A.AD 32.33 01.00.00.00 CE.A6");
+  skip_tx_response(api);
 
   api.request_timer(0, 1);
   vport.call_loop();
@@ -0,0 +1,105 @@
+#include <cstdlib>
+#include <new>
+
+#include "esphome/core/helpers.h"
+
+#include "../components/tion-api/tion-api-3s.h"
+#include "../components/tion-api/tion-api-3s-internal.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using dentra::tion::Tion3sApi;
+using dentra::tion::TionStateCall;
+using namespace dentra::tion_3s;
+
+namespace {
+bool alloc_tracking{};
+uint32_t alloc_count{};
+}  // namespace
+
+void *operator new(size_t size) {
+  if (alloc_tracking) {
+    alloc_count++;
+  }
+  if (void *ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t /*size*/) noexcept { std::free(ptr); }
+
+namespace {
+
+uint32_t tx_count{};
+bool write_frame(uint16_t type, const void *data, size_t size) {
+  tx_count++;
+  return true;
+}
+
+void read_state(Tion3sApi &api, const tion3s_state_t &st) {
+  api.read_frame(FRAME_TYPE_RSP(FRAME_TYPE_STATE_GET), &st, sizeof(st));
+}
+
+bool test_api_alloc() {
+  bool res = true;
+
+  esphome::test_set_millis(1000);
+
+  Tion3sApi api;
+  api.set_writer(Tion3sApi::writer_type::create<write_frame>());
+
+  tion3s_state_t st{};
+  st.fan_speed = 2;
+  st.gate_position = tion3s_state_t::GATE_POSITION_OUTDOOR;
+  st.target_temperature = 20;
+  st.flags.power_state = true;
+  st.flags.heater_state = true;
+  st.outdoor_temperature = 5;
+  read_state(api, st);
+
+  TionStateCall call(&api);
+  api.enable_boost(true, &call);
+  call.perform();
+
+  // verbose frame dump is always enabled in tests and allocates its hex string,
+  // so allocations of a bare write are subtracted from the measurements below
+  const uint8_t st_set[sizeof(tion3s_state_set_t)]{};
+  alloc_tracking = true;
+  alloc_count = 0;
+  api.write_frame(FRAME_TYPE_REQ(FRAME_TYPE_STATE_SET), st_set, sizeof(st_set));
+  alloc_tracking = false;
+  const uint32_t write_allocs = alloc_count;
+
+  // user changed fan speed, boost is canceled and previous state is restored
+  tx_count = 0;
+  st.fan_speed = 1;
+  alloc_tracking = true;
+  alloc_count = 0;
+  read_state(api, st);
+  alloc_tracking = false;
+  res &= cloak::check_data("boost cancel written", tx_count, 1u);
+  res &= cloak::check_data("boost cancel allocations", alloc_count - write_allocs, 0u);
+
+#ifdef TION_ENABLE_ANTIFRIZE
+  // heater is enabled by antifrize protection
+  tx_count = 0;
+  st.flags.heater_state = false;
+  st.outdoor_temperature = -5;
+  alloc_tracking = true;
+  alloc_count = 0;
+  read_state(api, st);
+  alloc_tracking = false;
+  res &= cloak::check_data("antifrize written", tx_count, 1u);
+  res &= cloak::check_data("antifrize allocations", alloc_count - write_allocs, 0u);
+#endif
+
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_api_alloc);
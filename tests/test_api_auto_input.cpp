@@ -0,0 +1,105 @@
+#include <cmath>
+
+#include "esphome/core/helpers.h"
+
+#include "../components/tion-api/auto_input.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using namespace dentra::tion::auto_co2;
+
+namespace {
+
+constexpr uint32_t ONE_MINUTE = 60 * 1000;
+
+bool test_api_auto_input_filter() {
+  bool res = true;
+
+  AutoInputFilter<5> filter;
+  res &= cloak::check_data("empty", std::isnan(filter.value()), true);
+
+  // single spike does not pass the median
+  const float samples[] = {600, 610, 2000, 620, 630, 640};
+  for (auto &&sample : samples) {
+    filter.update(sample);
+  }
+  res &= cloak::check_data("spike", filter.value(), 630.0f);
+
+  // sliding window forgets old samples
+  for (int i = 0; i < 5; i++) {
+    filter.update(900);
+  }
+  res &= cloak::check_data("window", filter.value(), 900.0f);
+
+  AutoInputFilter<3> ewma;
+  ewma.set_alpha(0.5f);
+  ewma.update(100);
+  ewma.update(100);
+  ewma.update(300);
+  ewma.update(300);
+  // medians 100, 100, 100, 300
+  res &= cloak::check_data("ewma", ewma.value(), 200.0f);
+
+  // runtime window is limited by max_window
+  AutoInputFilter<5> small;
+  small.set_window(8);
+  res &= cloak::check_data("window.max", uint32_t(small.get_window()), 5u);
+  small.set_window(1);
+  small.update(600);
+  small.update(2000);
+  res &= cloak::check_data("window.1", small.value(), 2000.0f);
+  small.set_window(3);
+  res &= cloak::check_data("window.reset", uint32_t(small.size()), 0u);
+  small.update(600);
+  small.update(2000);
+  small.update(610);
+  small.update(620);
+  res &= cloak::check_data("window.3", small.value(), 620.0f);
+
+  return res;
+}
+
+bool test_api_auto_input_pipeline() {
+  bool res = true;
+
+  esphome::test_set_millis(1);
+  AutoInputPipeline input;
+  input.set_timeout(10 * ONE_MINUTE);
+  res &= cloak::check_data("no data", input.demand(700), 0);
+
+  input.update(AUTO_SENSOR_CO2, 650);
+  res &= cloak::check_data("co2", input.demand(700), 650);
+
+  // disabled sensors are ignored
+  input.update(AUTO_SENSOR_PM25, 100);
+  res &= cloak::check_data("disabled", input.demand(700), 650);
+
+  input.set_sensor(AUTO_SENSOR_PM25, 25);
+  input.update(AUTO_SENSOR_PM25, 50);
+  res &= cloak::check_data("max of demands", input.demand(700), 1400);
+  input.update(AUTO_SENSOR_PM25, NAN);
+  res &= cloak::check_data("nan", input.get_value(AUTO_SENSOR_PM25), 50.0f);
+
+  // stale PM2.5 does not hold demand
+  esphome::test_set_millis(esphome::millis() + 8 * ONE_MINUTE);
+  input.update(AUTO_SENSOR_CO2, 650);
+  esphome::test_set_millis(esphome::millis() + 4 * ONE_MINUTE);
+  res &= cloak::check_data("stale", input.is_stale(AUTO_SENSOR_PM25), true);
+  res &= cloak::check_data("stale demand", input.demand(700), 650);
+
+  // fresh sample after staleness is not mixed with old ones
+  input.update(AUTO_SENSOR_PM25, 10);
+  res &= cloak::check_data("restart", input.get_value(AUTO_SENSOR_PM25), 10.0f);
+
+  esphome::test_set_millis(esphome::millis() + 20 * ONE_MINUTE);
+  res &= cloak::check_data("all stale", input.demand(700), 0);
+
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_api_auto_input_filter);
+REGISTER_TEST(test_api_auto_input_pipeline);
@@ -0,0 +1,74 @@
+#include "esphome/core/helpers.h"
+
+#include "../components/tion-api/auto_output.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using dentra::tion::auto_co2::AutoOutputStage;
+
+namespace {
+
+constexpr uint32_t ONE_MINUTE = 60 * 1000;
+
+const uint8_t PROD[] = {0, 30, 45, 60, 75, 90, 120};
+
+bool test_api_auto_output_hysteresis() {
+  bool res = true;
+
+  AutoOutputStage out;
+  res &= cloak::check_data("disabled", out.hold(61, 4, 3, PROD), 4);
+
+  out.set_hysteresis(20);
+  // speed 3 is in (45, 60], band is 3
+  res &= cloak::check_data("up inside", out.hold(63, 4, 3, PROD), 3);
+  res &= cloak::check_data("up outside", out.hold(64, 4, 3, PROD), 4);
+  res &= cloak::check_data("down inside", out.hold(43, 2, 3, PROD), 3);
+  res &= cloak::check_data("down outside", out.hold(42, 2, 3, PROD), 2);
+  res &= cloak::check_data("jump", out.hold(100, 6, 3, PROD), 6);
+  res &= cloak::check_data("no current", out.hold(10, 1, 0, PROD), 1);
+  res &= cloak::check_data("stats", out.get_stats().hysteresis, 2u);
+
+  return res;
+}
+
+bool test_api_auto_output_limit() {
+  bool res = true;
+
+  esphome::test_set_millis(1);
+  AutoOutputStage out;
+  res &= cloak::check_data("unlimited", out.allow() && out.allow(), true);
+
+  out.set_min_dwell(2 * ONE_MINUTE);
+  out.set_rate_limit(2, 10 * ONE_MINUTE);
+  esphome::test_set_millis(esphome::millis() + 5 * ONE_MINUTE);
+  res &= cloak::check_data("first", out.allow(), true);
+  res &= cloak::check_data("dwell", out.allow(), false);
+  esphome::test_set_millis(esphome::millis() + 2 * ONE_MINUTE);
+  res &= cloak::check_data("second", out.allow(), true);
+  esphome::test_set_millis(esphome::millis() + 2 * ONE_MINUTE);
+  res &= cloak::check_data("no tokens", out.allow(), false);
+  // the first token is earned back 10 min after it was spent
+  esphome::test_set_millis(esphome::millis() + 6 * ONE_MINUTE);
+  res &= cloak::check_data("refilled", out.allow(), true);
+  esphome::test_set_millis(esphome::millis() + 2 * ONE_MINUTE);
+  res &= cloak::check_data("no tokens again", out.allow(), false);
+  // bucket does not grow over burst
+  esphome::test_set_millis(esphome::millis() + 60 * ONE_MINUTE);
+  res &= cloak::check_data("burst 1", out.allow(), true);
+  esphome::test_set_millis(esphome::millis() + 2 * ONE_MINUTE);
+  res &= cloak::check_data("burst 2", out.allow(), true);
+  esphome::test_set_millis(esphome::millis() + 2 * ONE_MINUTE);
+  res &= cloak::check_data("burst end", out.allow(), false);
+
+  res &= cloak::check_data("dwell stats", out.get_stats().dwell, 1u);
+  res &= cloak::check_data("rate stats", out.get_stats().rate_limit, 3u);
+
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_api_auto_output_hysteresis);
+REGISTER_TEST(test_api_auto_output_limit);
@@ -0,0 +1,246 @@
+#ifdef TION_ENABLE_BENCH
+#include <chrono>
+#endif
+#include <cmath>
+
+#include "esphome/core/helpers.h"
+
+#include "../components/tion-api/tion-api-3s.h"
+#include "../components/tion-api/tion-api-4s.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using dentra::tion::TionApiBase;
+using dentra::tion::TionState;
+using dentra::tion::TionStateCall;
+using dentra::tion::TionTraits;
+
+namespace {
+
+constexpr uint32_t ONE_SECOND = 1000;
+constexpr uint32_t ONE_MINUTE = 60 * ONE_SECOND;
+constexpr uint32_t ONE_HOUR = 60 * ONE_MINUTE;
+constexpr uint32_t ONE_DAY = 24 * ONE_HOUR;
+
+/// Breezer which applies written state immediately, runs the real TionApiBase auto path.
+class SimApi : public TionApiBase {
+ public:
+  explicit SimApi(const TionTraits &traits) {
+    this->traits_ = traits;
+    this->state_.initialized = true;
+    this->state_.power_state = true;
+    this->state_.fan_speed = 1;
+    this->state_.target_temperature = 20;
+  }
+
+  void request_state() override {}
+  void write_state(TionStateCall *call) override {
+    const auto state = this->make_write_state_(call);
+    if (this->write_suppressed_(state)) {
+      return;
+    }
+    this->writes++;
+    this->state_.copy_fields(state, dentra::tion::STATE_FIELD_WRITABLE);
+    this->notify_state_(0);
+  }
+  void reset_filter() override {}
+
+  uint32_t writes{};
+};
+
+/// Well-mixed room CO2 mass balance.
+struct Room {
+  // room volume [m³]
+  float volume;
+  // CO2 generation per occupant [L/h], about 18 for sleeping or sitting adult
+  float generation;
+  float outdoor_ppm;
+  float ppm;
+
+  void step(float dt_s, int occupants, float airflow_m3h) {
+    // CO2 source [ppm/s]
+    const float source = occupants * generation * 1e-3f / 3600.0f * 1e6f / this->volume;
+    // ventilation sink [ppm/s]
+    const float sink = airflow_m3h / 3600.0f / this->volume * (this->ppm - this->outdoor_ppm);
+    this->ppm += (source - sink) * dt_s;
+  }
+};
+
+// Every SPIKE_INTERVAL sample of CO2 sensor is off by SPIKE ppm.
+constexpr uint32_t SPIKE_INTERVAL = 47;
+constexpr float SPIKE = 600;
+
+// Occupants by hour of a day: two sleeping at night, lunch at home, guests in the evening.
+const uint8_t OCCUPANCY[24] = {2, 2, 2, 2, 2, 2, 2, 2, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 2, 4, 4, 4, 2, 2};
+
+struct sim_config_t {
+  const char *name;
+  TionTraits traits;
+  float kp;
+  float ti;
+  int db;
+  uint16_t setpoint;
+  uint8_t min_fan_speed;
+  uint8_t max_fan_speed;
+  // enables hysteresis, min dwell and rate limit of auto output stage
+  bool limited;
+  // feeds samples directly bypassing auto input pipeline
+  bool direct;
+};
+
+struct sim_result_t {
+  // time for CO2 to return within setpoint + db after occupancy increase [min]
+  float settling_avg;
+  float settling_max;
+  // max CO2 above setpoint [ppm]
+  float overshoot;
+  float ppm_avg;
+  // fan speed switches, each one is a breezer write
+  uint32_t switches;
+  uint32_t writes;
+  // fan energy [Wh]
+  float energy;
+  // changes suppressed by auto output stage
+  dentra::tion::auto_co2::AutoOutputStage::stats_t suppressed;
+};
+
+sim_result_t simulate(const sim_config_t &cfg, uint32_t duration, uint32_t sample_interval) {
+  SimApi api(cfg.traits);
+  api.set_auto_pi_data(cfg.kp, cfg.ti, cfg.db);
+  api.set_auto_setpoint(cfg.setpoint);
+  api.set_auto_max_fan_speed(cfg.max_fan_speed);
+  api.set_auto_min_fan_speed(cfg.min_fan_speed);
+  if (cfg.limited) {
+    api.set_auto_hysteresis(25);
+    api.set_auto_min_dwell(2 * ONE_MINUTE);
+    api.set_auto_rate_limit(4, 10 * ONE_MINUTE);
+  }
+
+  TionStateCall call(&api);
+  call.set_auto_state(true);
+  call.perform();
+  api.writes = 0;
+
+  Room room{.volume = 45, .generation = 18, .outdoor_ppm = 420, .ppm = 600};
+  sim_result_t res{};
+  const float band = cfg.setpoint + cfg.db;
+  uint32_t settle_start = 0;
+  uint32_t settle_events = 0;
+  float settling_sum = 0;
+  bool settling = false;
+  bool exceeded = false;
+  double ppm_sum = 0;
+  uint32_t samples = 0;
+  uint8_t fan_speed = api.get_state().fan_speed;
+  uint8_t occupants = OCCUPANCY[0];
+
+  constexpr uint32_t room_step = 10 * ONE_SECOND;
+  const uint32_t start = esphome::millis();
+  for (uint32_t time = 0; time < duration; time += room_step) {
+    esphome::test_set_millis(start + time);
+
+    const uint8_t now_occupants = OCCUPANCY[(time % ONE_DAY) / ONE_HOUR];
+    if (now_occupants > occupants && !settling) {
+      settling = true;
+      exceeded = false;
+      settle_start = time;
+    }
+    occupants = now_occupants;
+
+    if (time % sample_interval == 0) {
+      // sensor glitch
+      const float sample = samples % SPIKE_INTERVAL == SPIKE_INTERVAL - 1 ? room.ppm + SPIKE : room.ppm;
+      const bool changed = cfg.direct ? api.auto_update(static_cast<uint16_t>(sample), &call)
+                                      : api.auto_update(dentra::tion::auto_co2::AUTO_SENSOR_CO2, sample, &call);
+      if (changed) {
+        call.perform();
+      }
+      ppm_sum += room.ppm;
+      samples++;
+    }
+
+    const auto &state = api.get_state();
+    if (state.fan_speed != fan_speed) {
+      res.switches++;
+      fan_speed = state.fan_speed;
+    }
+    const uint8_t speed = state.power_state ? state.fan_speed : 0;
+    room.step(room_step / 1000.0f, occupants, api.get_traits().auto_prod[speed]);
+    res.energy += api.get_traits().get_max_fan_power(speed) * room_step / float(ONE_HOUR);
+
+    res.overshoot = std::max(res.overshoot, room.ppm - cfg.setpoint);
+    exceeded |= room.ppm > band;
+    if (settling && exceeded && room.ppm <= band) {
+      const float minutes = float(time - settle_start) / ONE_MINUTE;
+      settling_sum += minutes;
+      res.settling_max = std::max(res.settling_max, minutes);
+      settle_events++;
+      settling = false;
+    }
+  }
+
+  res.settling_avg = settle_events ? settling_sum / settle_events : 0;
+  res.ppm_avg = samples ? ppm_sum / samples : 0;
+  res.writes = api.writes;
+  res.suppressed = api.get_auto_stats();
+  return res;
+}
+
+TionTraits traits_4s() { return dentra::tion_4s::Tion4sApi().get_traits(); }
+TionTraits traits_3s() { return dentra::tion::Tion3sApi().get_traits(); }
+
+bool test_api_auto_sim() {
+  bool res = true;
+
+  const sim_config_t configs[] = {
+      {"4s default", traits_4s(), TION_AUTO_KP, TION_AUTO_TI, TION_AUTO_DB, 800, 1, 6},
+      {"4s limited", traits_4s(), TION_AUTO_KP, TION_AUTO_TI, TION_AUTO_DB, 800, 1, 6, true},
+      {"4s direct", traits_4s(), TION_AUTO_KP, TION_AUTO_TI, TION_AUTO_DB, 800, 1, 6, false, true},
+      {"4s kp*2", traits_4s(), TION_AUTO_KP * 2, TION_AUTO_TI, TION_AUTO_DB, 800, 1, 6},
+      {"4s ti*2", traits_4s(), TION_AUTO_KP, TION_AUTO_TI * 2, TION_AUTO_DB, 800, 1, 6},
+      {"4s db=50", traits_4s(), TION_AUTO_KP, TION_AUTO_TI, 50, 800, 1, 6},
+      {"3s default", traits_3s(), TION_AUTO_KP, TION_AUTO_TI, TION_AUTO_DB, 800, 1, 6},
+  };
+  constexpr uint32_t days = 7;
+
+  sim_result_t results[std::size(configs)];
+#ifdef TION_ENABLE_BENCH
+  // timing depends on the host, so it is reported with TION_ENABLE_BENCH only
+  using namespace std::chrono;
+  const auto t1 = high_resolution_clock::now();
+#endif
+  for (size_t i = 0; i < std::size(configs); i++) {
+    results[i] = simulate(configs[i], days * ONE_DAY, ONE_MINUTE);
+  }
+#ifdef TION_ENABLE_BENCH
+  const duration<double> time_span = high_resolution_clock::now() - t1;
+  printf("%u days per config simulated in %.3f s\n", days, time_span.count() / std::size(configs));
+#endif
+
+  printf("%-12s %10s %10s %10s %8s %9s %7s %10s %6s %6s %6s\n", "config", "settle_avg", "settle_max", "overshoot",
+         "ppm_avg", "switches", "writes", "energy_Wh", "hyst", "dwell", "rate");
+  for (size_t i = 0; i < std::size(configs); i++) {
+    const auto &r = results[i];
+    printf("%-12s %10.1f %10.1f %10.1f %8.1f %9u %7u %10.1f %6u %6u %6u\n", configs[i].name, r.settling_avg,
+           r.settling_max, r.overshoot, r.ppm_avg, r.switches, r.writes, r.energy, r.suppressed.hysteresis,
+           r.suppressed.dwell, r.suppressed.rate_limit);
+  }
+
+  // sanity of the default tuning
+  const auto &def = results[0];
+  res &= cloak::check_data("controlled", def.ppm_avg < configs[0].setpoint + 100, true);
+  res &= cloak::check_data("switches", def.switches > 0 && def.switches == def.writes, true);
+  res &= cloak::check_data("energy", def.energy > 0, true);
+  // output stage must reduce writes
+  res &= cloak::check_data("output stage", results[1].writes < def.writes, true);
+  // input pipeline must not let sensor spikes through
+  res &= cloak::check_data("input pipeline", def.writes < results[2].writes, true);
+
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_api_auto_sim);
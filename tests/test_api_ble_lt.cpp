@@ -0,0 +1,96 @@
+#include <vector>
+
+#include "esphome/core/helpers.h"
+
+#include "../components/tion-api/tion-api-ble-lt.h"
+#include "../components/tion-api/tion-api-4s-internal.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using dentra::tion::TionLtBleProtocol;
+
+namespace {
+
+std::vector<std::vector<uint8_t>> tx_packets;
+bool write_data(const uint8_t *data, size_t size) {
+  tx_packets.emplace_back(data, data + size);
+  return true;
+}
+
+std::vector<uint16_t> rx_types;
+void read_frame(const TionLtBleProtocol::frame_spec_type &frame, size_t size) { rx_types.push_back(frame.type); }
+
+std::vector<std::vector<uint8_t>> make_packets(uint16_t type, size_t size, uint16_t mtu = 23) {
+  tx_packets.clear();
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; i++) {
+    data[i] = i;
+  }
+  TionLtBleProtocol pr;
+  pr.writer = TionLtBleProtocol::writer_type::create<write_data>();
+  pr.set_mtu(mtu);
+  pr.write_frame(type, data.data(), data.size());
+  return tx_packets;
+}
+
+void read_packets(TionLtBleProtocol &pr, const std::vector<std::vector<uint8_t>> &packets) {
+  for (auto &&pkt : packets) {
+    pr.read_data(pkt.data(), pkt.size());
+  }
+}
+
+bool test_api_ble_lt() {
+  bool res = true;
+
+  const auto lone = make_packets(dentra::tion_4s::FRAME_TYPE_STATE_REQ, 0);
+  const auto multi = make_packets(dentra::tion_4s::FRAME_TYPE_STATE_RSP, 64);
+  const auto large = make_packets(dentra::tion_4s::FRAME_TYPE_TEST_RSP, 440);
+  const auto huge = make_packets(dentra::tion_4s::FRAME_TYPE_TEST_RSP, 600);
+
+  res &= cloak::check_data("lone packets", uint32_t(lone.size()), 1u);
+  res &= cloak::check_data("multi packets", uint32_t(multi.size()), 4u);
+
+  rx_types.clear();
+  esphome::test_set_millis(1000);
+
+  TionLtBleProtocol pr;
+  pr.reader = TionLtBleProtocol::reader_type::create<read_frame>();
+
+  read_packets(pr, lone);
+  read_packets(pr, multi);
+  read_packets(pr, large);
+  // overflowed frame is skipped until the next FRST
+  read_packets(pr, huge);
+  // FRST interrupts a frame in progress
+  read_packets(pr, {multi[0], multi[1]});
+  read_packets(pr, multi);
+  // CURR without FRST
+  read_packets(pr, {multi[1]});
+  // timeout between packets
+  read_packets(pr, {multi[0], multi[1]});
+  esphome::test_set_millis(5000);
+  read_packets(pr, {multi[2], multi[3]});
+  read_packets(pr, multi);
+  // negotiated MTU
+  const auto large_mtu = make_packets(dentra::tion_4s::FRAME_TYPE_TEST_RSP, 440, 247);
+  res &= cloak::check_data("large_mtu packets", uint32_t(large_mtu.size()), 2u);
+  res &= cloak::check_data("large_mtu packet size", uint32_t(large_mtu[0].size()), 244u);
+  read_packets(pr, large_mtu);
+
+  const auto &stats = pr.get_rx_stats();
+  res &= cloak::check_data("frames", uint32_t(rx_types.size()), 6u);
+  res &= cloak::check_data("frames[2]", uint32_t(rx_types.size() > 2 ? rx_types[2] : 0),
+                           uint32_t(dentra::tion_4s::FRAME_TYPE_TEST_RSP));
+  res &= cloak::check_data("stats.frames", stats.frames, 6u);
+  res &= cloak::check_data("stats.overflowed", stats.overflowed, 1u);
+  res &= cloak::check_data("stats.orphaned", stats.orphaned, 2u);
+  res &= cloak::check_data("stats.timeouts", stats.timeouts, 1u);
+
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_api_ble_lt);
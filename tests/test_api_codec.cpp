@@ -0,0 +1,150 @@
+#include <vector>
+
+#include "esphome/core/helpers.h"
+
+#include "../components/tion-api/tion-api.h"
+#include "../components/tion-api/tion-api-codec.h"
+#include "../components/tion-api/tion-api-3s.h"
+#include "../components/tion-api/tion-api-3s-internal.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using dentra::tion::CommSource;
+using dentra::tion::TionCodec;
+using dentra::tion::TionGatePosition;
+using dentra::tion::TionState;
+using dentra::tion::TionTraits;
+
+namespace {
+
+bool test_api_codec_state() {
+  bool res = true;
+
+  TionState state{};
+  state.initialized = true;
+  state.power_state = true;
+  state.heater_state = true;
+  state.gate_error_state = true;
+  state.comm_source = CommSource::USER;
+  state.fan_speed = 4;
+  state.gate_position = TionGatePosition::MIXED;
+  state.outdoor_temperature = -12;
+  state.current_temperature = 18;
+  state.target_temperature = 21;
+  state.productivity = 60;
+  state.heater_var = 50;
+  state.work_time = 0x01020304;
+  state.fan_time = 0x11121314;
+  state.filter_time_left = 0x21222324;
+  state.airflow_counter = 0x31323334;
+  state.airflow_m3 = 1.5f;
+  state.boost_time_left = 600;
+  state.firmware_version = 0x0456;
+  state.hardware_version = 0x0789;
+  state.pcb_ctl_temperature = 30;
+  state.pcb_pwr_temperature = -1;
+  state.errors = 0x80000001;
+
+  uint8_t buf[TionCodec::STATE_SIZE];
+  res &= cloak::check_data("state size", uint32_t(TionCodec::encode(state, buf)), uint32_t(TionCodec::STATE_SIZE));
+  res &= cloak::check_data("state data", std::vector<uint8_t>(buf, buf + sizeof(buf)),
+                           "53.10.C3.29.F4.12.15.3C.32.04.03.02.01.14.13.12.11.24.23.22.21.34.33.32.31.00.00.C0.3F."
+                           "58.02.56.04.89.07.1E.FF.01.00.00.80");
+
+  TionState decoded{};
+  res &= cloak::check_data("state decode", TionCodec::decode(buf, sizeof(buf), &decoded), true);
+  uint8_t buf2[TionCodec::STATE_SIZE];
+  TionCodec::encode(decoded, buf2);
+  res &= cloak::check_data("state round trip", std::vector<uint8_t>(buf2, buf2 + sizeof(buf2)),
+                           std::vector<uint8_t>(buf, buf + sizeof(buf)));
+  res &= cloak::check_data("state gate", decoded.gate_position == TionGatePosition::MIXED, true);
+  res &= cloak::check_data("state temp", decoded.outdoor_temperature, -12);
+
+  res &= cloak::check_data("state short", TionCodec::decode(buf, sizeof(buf) - 1, &decoded), false);
+  buf[0] = TionCodec::TYPE_TRAITS;
+  res &= cloak::check_data("state type", TionCodec::decode(buf, sizeof(buf), &decoded), false);
+  buf[0] = TionCodec::TYPE_STATE;
+  buf[1] = (TionCodec::VERSION_MAJOR + 1) << 4;
+  res &= cloak::check_data("state major", TionCodec::decode(buf, sizeof(buf), &decoded), false);
+
+  // newer minor version with appended field
+  uint8_t next[TionCodec::STATE_SIZE + 2];
+  TionCodec::encode(state, next);
+  next[1] = TionCodec::VERSION + 1;
+  next[TionCodec::STATE_SIZE] = 0xAA;
+  next[TionCodec::STATE_SIZE + 1] = 0x55;
+  decoded = {};
+  res &= cloak::check_data("state minor", TionCodec::decode(next, sizeof(next), &decoded), true);
+  res &= cloak::check_data("state minor errors", decoded.errors, state.errors);
+
+  return res;
+}
+
+bool test_api_codec_traits() {
+  bool res = true;
+
+  TionTraits traits{};
+  traits.supports_led_state = true;
+  traits.supports_boost = true;
+  traits.supports_reset_filter = true;
+  traits.boost_time = 1200;
+  traits.boost_heater_state = 1;
+  traits.boost_target_temperature = 10;
+  traits.max_fan_speed = 6;
+  traits.min_target_temperature = -30;
+  traits.max_target_temperature = 25;
+  traits.max_heater_power = 145;
+  for (size_t i = 0; i < std::size(traits.max_fan_power); i++) {
+    traits.max_fan_power[i] = 0x100 + i;
+  }
+
+  uint8_t buf[TionCodec::TRAITS_SIZE];
+  res &= cloak::check_data("traits size", uint32_t(TionCodec::encode(traits, buf)), uint32_t(TionCodec::TRAITS_SIZE));
+  res &= cloak::check_data("traits data", std::vector<uint8_t>(buf, buf + sizeof(buf)),
+                           "54.10.01.30.B0.04.01.0A.06.E2.19.91.00.01.01.01.02.01.03.01.04.01.05.01.06.01");
+
+  const uint8_t auto_prod[] = {1, 2};
+  TionTraits decoded{};
+  decoded.auto_prod = auto_prod;
+  res &= cloak::check_data("traits decode", TionCodec::decode(buf, sizeof(buf), &decoded), true);
+  res &= cloak::check_data("traits auto_prod kept", decoded.auto_prod == auto_prod, true);
+  uint8_t buf2[TionCodec::TRAITS_SIZE];
+  TionCodec::encode(decoded, buf2);
+  res &= cloak::check_data("traits round trip", std::vector<uint8_t>(buf2, buf2 + sizeof(buf2)),
+                           std::vector<uint8_t>(buf, buf + sizeof(buf)));
+
+  res &= cloak::check_data("traits as state", TionCodec::decode(buf, sizeof(buf), static_cast<TionState *>(nullptr)),
+                           false);
+
+  return res;
+}
+
+// Whole decoded state is checked against golden encoded data instead of field by field.
+bool test_api_codec_golden() {
+  using namespace dentra::tion_3s;
+  bool res = true;
+
+  // 3S has no work time in the state, it is taken from uptime
+  esphome::test_set_millis(0);
+  dentra::tion::Tion3sApi api;
+  const auto frame = cloak::from_hex("22.14.03.00.12.13.FB.64.00.0C.1E.00.2D.0A.00.3C.00");
+  res &= cloak::check_data("3s frame size", uint32_t(frame.size()), uint32_t(sizeof(tion3s_state_t)));
+  api.read_frame(FRAME_TYPE_RSP(FRAME_TYPE_STATE_GET), frame.data(), frame.size());
+
+  uint8_t buf[TionCodec::STATE_SIZE];
+  TionCodec::encode(api.get_state(), buf);
+  // power and heater, fan speed 2, outdoor gate, -5/18/20 °C, 45 m³/h, 100 days of filter, firmware 0x003C
+  res &= cloak::check_data("3s state", std::vector<uint8_t>(buf, buf + sizeof(buf)),
+                           "53.10.03.05.FB.12.14.2D.00.00.00.00.00.00.00.00.00.00.D6.83.00.00.00.00.00.00.00.00.00."
+                           "00.00.3C.00.00.00.00.00.00.00.00.00");
+
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_api_codec_state);
+REGISTER_TEST(test_api_codec_traits);
+REGISTER_TEST(test_api_codec_golden);
@@ -10,6 +10,7 @@
 #include <iostream>
 #include <new>
 #include <vector>
+#include <algorithm>
 
 #include "utils.h"
 
@@ -99,4 +100,86 @@ bool test_api_crc() {
   return res;
 }
 
+struct crc_impl_t {
+  const char *name;
+  uint16_t (*fn)(uint16_t init, const void *data, size_t size);
+  size_t table_size;
+};
+
+const crc_impl_t crc_impls[] = {
+    {"nibble", crc16_ccitt_false_nibble, CRC16_CCITT_FALSE_NIBBLE_TABLE_SIZE},
+    {"slice1", crc16_ccitt_false_slice1, CRC16_CCITT_FALSE_SLICE1_TABLE_SIZE},
+    {"slice4", crc16_ccitt_false_slice4, CRC16_CCITT_FALSE_SLICE4_TABLE_SIZE},
+    {"slice8", crc16_ccitt_false_slice8, CRC16_CCITT_FALSE_SLICE8_TABLE_SIZE},
+};
+
+bool test_api_crc_impl() {
+  bool res = true;
+
+  // check value for CRC-16/CCITT-FALSE
+  const char check[] = "123456789";
+  for (auto &&impl : crc_impls) {
+    res &= cloak::check_data(std::string(impl.name) + " check", uint32_t(impl.fn(0xFFFF, check, sizeof(check) - 1)),
+                             0x29B1u);
+  }
+
+  // all sizes and tails must match byte-wise implementation
+  uint8_t buf[67];
+  for (auto &&b : buf) {
+    b = fast_random_8();
+  }
+  for (size_t size = 0; size <= sizeof(buf); size++) {
+    const auto crc = crc16_ccitt_false_slice1(0xFFFF, buf, size);
+    for (auto &&impl : crc_impls) {
+      if (impl.fn(0xFFFF, buf, size) != crc) {
+        res &= cloak::check_data(std::string(impl.name) + " size " + std::to_string(size),
+                                 uint32_t(impl.fn(0xFFFF, buf, size)), uint32_t(crc));
+      }
+    }
+  }
+
+  // streaming must match single pass calculation
+  Crc16Ccitt crc;
+  for (size_t pos = 0; pos < sizeof(buf); pos += 19) {
+    crc.update(buf + pos, std::min(sizeof(buf) - pos, size_t(19)));
+  }
+  res &= cloak::check_data("streaming", uint32_t(crc.value()), uint32_t(crc16_ccitt_false_ffff(buf, sizeof(buf))));
+
+  return res;
+}
+
+#ifdef TION_ENABLE_BENCH
+// Timing only, results depend on the host, so it is built with TION_ENABLE_BENCH only.
+bool test_api_crc_bench() {
+  // typical frame sizes: 4S state response, BLE packet and tion_rc firmware chunk
+  const size_t sizes[] = {20, 47, 512};
+  constexpr size_t total = 16 * 1024 * 1024;
+
+  std::vector<uint8_t> buf(512);
+  for (auto &&b : buf) {
+    b = fast_random_8();
+  }
+
+  printf("%-8s %6s %6s %10s\n", "impl", "table", "frame", "MB/s");
+  for (auto &&impl : crc_impls) {
+    for (auto size : sizes) {
+      using namespace std::chrono;
+      volatile uint16_t crc = 0xFFFF;
+      const auto t1 = high_resolution_clock::now();
+      for (size_t done = 0; done < total; done += size) {
+        crc = impl.fn(crc, buf.data(), size);
+      }
+      const duration<double> time_span = high_resolution_clock::now() - t1;
+      printf("%-8s %6zu %6zu %10.1f\n", impl.name, impl.table_size, size, total / time_span.count() / 1e6);
+    }
+  }
+
+  return true;
+}
+#endif  // TION_ENABLE_BENCH
+
 REGISTER_TEST(test_api_crc);
+REGISTER_TEST(test_api_crc_impl);
+#ifdef TION_ENABLE_BENCH
+REGISTER_TEST(test_api_crc_bench);
+#endif
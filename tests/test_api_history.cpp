@@ -0,0 +1,123 @@
+#include <string>
+
+#include "esphome/core/helpers.h"
+
+#include "../components/tion-api/tion-api.h"
+#include "../components/tion-api/tion-api-history.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using dentra::tion::TionState;
+using dentra::tion::TionStateHistory;
+using dentra::tion::tion_history_header_t;
+using dentra::tion::tion_history_record_t;
+
+namespace {
+
+bool test_api_history() {
+  bool res = true;
+
+  esphome::test_set_millis(10000);
+
+  TionStateHistory<4> history;
+  TionState state{};
+  state.power_state = true;
+  state.fan_speed = 2;
+  state.outdoor_temperature = -5;
+
+  res &= cloak::check_data("first", history.push(state), true);
+  esphome::test_set_millis(20000);
+  res &= cloak::check_data("not changed", history.push(state), false);
+  state.work_time = 100;
+  res &= cloak::check_data("counters", history.push(state), false);
+
+  for (uint8_t fan_speed = 3; fan_speed <= 6; fan_speed++) {
+    esphome::test_set_millis(esphome::millis() + 5000);
+    state.fan_speed = fan_speed;
+    history.push(state);
+  }
+  res &= cloak::check_data("size", uint32_t(history.size()), 4u);
+
+  // the oldest records are overwritten
+  std::string times;
+  std::string speeds;
+  for (const auto &entry : history) {
+    times += std::to_string(entry.time) + " ";
+    speeds += std::to_string(entry.record.fan_speed) + " ";
+  }
+  res &= cloak::check_data("times", times, std::string("25 30 35 40 "));
+  res &= cloak::check_data("speeds", speeds, std::string("3 4 5 6 "));
+
+  // long time without changes
+  esphome::test_set_millis(esphome::millis() + 70000 * 1000);
+  state.heater_state = true;
+  history.push(state);
+  uint32_t last_time = 0;
+  for (const auto &entry : history) {
+    last_time = entry.time;
+  }
+  res &= cloak::check_data("gap", last_time, 70040u);
+
+  std::string bin;
+  history.write_binary([&bin](const char *data, size_t size) { bin.append(data, size); });
+  res &= cloak::check_data("bin.size", uint32_t(bin.size()),
+                           uint32_t(sizeof(tion_history_header_t) + 4 * sizeof(tion_history_record_t)));
+
+  std::string csv;
+  history.write_csv([&csv](const char *data, size_t size) { csv.append(data, size); });
+  const auto last_line = csv.substr(csv.rfind('\n', csv.size() - 2) + 1);
+  res &= cloak::check_data("csv", last_line, std::string("70040,1,1,0,0,0,0,0,0,6,0,-5,0,0,0,00000000\n"));
+
+  return res;
+}
+
+bool test_api_history_wrap() {
+  bool res = true;
+
+  TionStateHistory<4> history;
+  TionState state{};
+  state.fan_speed = 1;
+
+  // millis() wraps between records
+  esphome::test_set_millis(UINT32_MAX - 2500);
+  history.push(state);
+  esphome::test_set_millis(1000);
+  state.fan_speed = 2;
+  history.push(state);
+  // carried fraction of a second
+  esphome::test_set_millis(1600);
+  state.fan_speed = 3;
+  history.push(state);
+  res &= cloak::check_data("wrap.size", uint32_t(history.size()), 3u);
+
+  std::string deltas;
+  for (const auto &entry : history) {
+    deltas += std::to_string(entry.record.time_delta) + " ";
+  }
+  res &= cloak::check_data("wrap.deltas", deltas, std::string("0 3 1 "));
+
+  // gap longer than the whole history is not filled with more than capacity records
+  uint32_t first_time = 0;
+  for (const auto &entry : history) {
+    first_time = entry.time;
+    break;
+  }
+  esphome::test_set_millis(1600 + 40u * 24 * 3600 * 1000);
+  state.fan_speed = 4;
+  history.push(state);
+  res &= cloak::check_data("long gap.size", uint32_t(history.size()), 4u);
+  uint32_t last_time = 0;
+  for (const auto &entry : history) {
+    last_time = entry.time;
+  }
+  res &= cloak::check_data("long gap.time", last_time - first_time, 4u + 40 * 24 * 3600);
+
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_api_history);
+REGISTER_TEST(test_api_history_wrap);
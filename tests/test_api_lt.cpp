@@ -42,10 +42,12 @@ bool test_api_lt() {
   api.request_state();
   vport.call_loop();
   res &= cloak::check_data("request_state", io, "80.0C.00.3A.AD.32.12.01.00.00.00.6C.43");
+  skip_tx_response(api);
 
   api.request_dev_info();
   vport.call_loop();
   res &= cloak::check_data("request_dev_info", io, "80.0C.00.3A.AD.09.40.01.00.00.00.D1.DC");
+  skip_tx_response(api);
 
   TionState st{};
   st.power_state = true;
@@ -0,0 +1,93 @@
+#include "esphome/core/helpers.h"
+
+#include "../components/tion-api/tion-api-3s.h"
+#include "../components/tion-api/tion-api-3s-internal.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using dentra::tion::Tion3sApi;
+using dentra::tion::TionApiBase;
+using dentra::tion::TionState;
+using dentra::tion::TionStateCall;
+using namespace dentra::tion_3s;
+
+namespace {
+
+bool write_frame(uint16_t type, const void *data, size_t size) { return true; }
+
+uint8_t notified_fan_speed{};
+uint32_t notified_request_id{};
+void on_state(const TionState &state, uint32_t changes, uint32_t request_id) {
+  notified_fan_speed = state.fan_speed;
+  notified_request_id = request_id;
+}
+
+void read_state(Tion3sApi &api, uint8_t fan_speed) {
+  tion3s_state_t st{};
+  st.fan_speed = fan_speed;
+  st.gate_position = tion3s_state_t::GATE_POSITION_OUTDOOR;
+  st.target_temperature = 20;
+  st.flags.power_state = true;
+  api.read_frame(FRAME_TYPE_RSP(FRAME_TYPE_STATE_GET), &st, sizeof(st));
+}
+
+void set_fan_speed(Tion3sApi &api, uint8_t fan_speed) {
+  TionStateCall call(&api);
+  call.set_fan_speed(fan_speed);
+  call.perform();
+}
+
+bool test_api_optimistic() {
+  bool res = true;
+
+  esphome::test_set_millis(1000);
+
+  Tion3sApi api;
+  api.set_writer(Tion3sApi::writer_type::create<write_frame>());
+  api.on_state_fn.set<on_state>();
+  api.set_optimistic(true);
+  read_state(api, 2);
+
+  // written state is notified immediately
+  set_fan_speed(api, 4);
+  res &= cloak::check_data("optimistic", notified_fan_speed, 4);
+  res &= cloak::check_data("optimistic id", notified_request_id, TionApiBase::OPTIMISTIC_REQUEST_ID);
+  res &= cloak::check_data("pending", api.get_pending_fields(), uint32_t(dentra::tion::STATE_FIELD_FAN_SPEED));
+
+  // state requested before the write keeps pending value
+  read_state(api, 2);
+  res &= cloak::check_data("outdated", notified_fan_speed, 4);
+  res &= cloak::check_data("outdated id", notified_request_id, 0u);
+
+  // breezer refused the change, the write is retried before rollback
+  for (int i = 0; i < TionApiBase::WRITE_MAX_RETRIES * 2; i++) {
+    read_state(api, 2);
+    res &= cloak::check_data("retrying", notified_fan_speed, 4);
+  }
+  read_state(api, 2);
+  res &= cloak::check_data("refused", notified_fan_speed, 2);
+  res &= cloak::check_data("refused pending", api.get_pending_fields(), 0u);
+
+  // breezer confirmed the change
+  set_fan_speed(api, 5);
+  read_state(api, 5);
+  res &= cloak::check_data("confirmed", notified_fan_speed, 5);
+  res &= cloak::check_data("confirmed pending", api.get_pending_fields(), 0u);
+
+  // no response in time
+  set_fan_speed(api, 3);
+  api.loop();
+  res &= cloak::check_data("waiting", notified_fan_speed, 3);
+  esphome::test_set_millis(1000 + TION_OPTIMISTIC_TIMEOUT);
+  api.loop();
+  res &= cloak::check_data("timed out", notified_fan_speed, 5);
+  res &= cloak::check_data("timed out pending", api.get_pending_fields(), 0u);
+
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_api_optimistic);
@@ -0,0 +1,119 @@
+#include <chrono>
+#include <cmath>
+#include <vector>
+#if defined(TION_ENABLE_BENCH) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+#include "esphome/core/helpers.h"
+
+#include "../components/tion-api/pi_controller.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using dentra::tion::auto_co2::FixedPIController;
+using dentra::tion::auto_co2::PIController;
+
+namespace {
+
+constexpr uint32_t ONE_MINUTE = 60 * 1000;
+
+// CO2 samples [ppm] of a bedroom night and an office day
+const uint16_t TRACE_NIGHT[] = {450, 470, 510, 600, 680, 720, 780, 810, 770, 740, 710, 690, 650, 630, 610,
+                                640, 700, 760, 830, 910, 960, 990, 940, 880, 820, 760, 720, 700, 690, 680};
+const uint16_t TRACE_OFFICE[] = {420,  430,  520,  650,  820,  980,  1150, 1280, 1350, 1320, 1250, 1100,
+                                 950,  870,  900,  1010, 1150, 1300, 1450, 1600, 1550, 1400, 1200, 1000,
+                                 850,  720,  600,  520,  480,  450,  440,  430,  425,  420,  420,  420};
+
+struct trace_t {
+  const char *name;
+  const uint16_t *data;
+  size_t size;
+  uint32_t step;
+  float min;
+  float max;
+};
+
+// max difference of airflow [L/s] between float and fixed controllers
+float trace_max_error(const trace_t &trace) {
+  PIController ref(0.2736, 8, 20, trace.min, trace.max);
+  FixedPIController fix(0.2736, 8, 20, trace.min, trace.max);
+  float max_error = 0;
+  esphome::test_set_millis(1);
+  // run the trace twice to check integral error with long history
+  for (int pass = 0; pass < 2; pass++) {
+    for (size_t i = 0; i < trace.size; i++) {
+      const float expected = ref.update(700, trace.data[i]);
+      const float actual = static_cast<float>(fix.update(700, trace.data[i]));
+      max_error = std::max(max_error, std::fabs(expected - actual));
+      esphome::test_set_millis(esphome::millis() + trace.step);
+    }
+  }
+  return max_error;
+}
+
+bool test_api_pi() {
+  bool res = true;
+
+  const trace_t traces[] = {
+      {"night", TRACE_NIGHT, std::size(TRACE_NIGHT), 10 * ONE_MINUTE, 30, 60},
+      {"office", TRACE_OFFICE, std::size(TRACE_OFFICE), 5 * ONE_MINUTE, 15, 120},
+      {"unbounded", TRACE_OFFICE, std::size(TRACE_OFFICE), 1 * ONE_MINUTE, NAN, NAN},
+      {"fast", TRACE_NIGHT, std::size(TRACE_NIGHT), 10 * 1000, 30, 60},
+  };
+  for (auto &&trace : traces) {
+    const float max_error = trace_max_error(trace);
+    ESP_LOGD(TAG, "%s max error: %f L/s", trace.name, max_error);
+    res &= cloak::check_data(std::string(trace.name) + " tolerance", max_error < 0.25f, true);
+  }
+
+  // truncation must match float to int conversion used to select fan speed
+  res &= cloak::check_data("to int", static_cast<int>(dentra::tion::auto_co2::PIFixed(-3.5f)), -3);
+  res &= cloak::check_data("saturate", dentra::tion::auto_co2::PIFixed::highest() + 1 ==
+                                           dentra::tion::auto_co2::PIFixed::highest(),
+                           true);
+
+  return res;
+}
+
+#ifdef TION_ENABLE_BENCH
+// Timing only, results depend on the host, so it is built with TION_ENABLE_BENCH only.
+template<class controller_t> void bench_controller(const char *name) {
+  constexpr int iterations = 1000000;
+  controller_t pi(0.2736, 8, 20, 15, 120);
+  volatile int sink = 0;
+  esphome::test_set_millis(1);
+  using namespace std::chrono;
+  const auto t1 = high_resolution_clock::now();
+#if defined(__x86_64__) || defined(__i386__)
+  const auto c1 = __rdtsc();
+#endif
+  for (int i = 0; i < iterations; i++) {
+    esphome::test_set_millis(esphome::millis() + ONE_MINUTE);
+    sink = static_cast<int>(pi.update(700, TRACE_OFFICE[i % std::size(TRACE_OFFICE)]));
+  }
+#if defined(__x86_64__) || defined(__i386__)
+  const double cycles = double(__rdtsc() - c1) / iterations;
+#else
+  const double cycles = 0;
+#endif
+  const duration<double> time_span = high_resolution_clock::now() - t1;
+  printf("%-8s %10.1f %10.1f\n", name, time_span.count() * 1e9 / iterations, cycles);
+}
+
+bool test_api_pi_bench() {
+  printf("%-8s %10s %10s\n", "impl", "ns/update", "cycles");
+  bench_controller<PIController>("float");
+  bench_controller<FixedPIController>("fixed");
+  return true;
+}
+#endif  // TION_ENABLE_BENCH
+
+}  // namespace
+
+REGISTER_TEST(test_api_pi);
+#ifdef TION_ENABLE_BENCH
+REGISTER_TEST(test_api_pi_bench);
+#endif
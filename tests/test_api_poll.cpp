@@ -0,0 +1,143 @@
+#include <vector>
+
+#include "esphome/core/helpers.h"
+
+#include "../components/tion-api/tion-api-poll.h"
+#include "../components/tion-api/tion-api-tx-queue.h"
+#include "../components/tion-api/tion-api-4s.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using dentra::tion::TionPollCycle;
+using dentra::tion::TionTxQueue;
+using dentra::tion_4s::Tion4sApi;
+
+namespace {
+
+std::vector<int> sent;
+bool request_1() {
+  sent.push_back(1);
+  return true;
+}
+bool request_2() {
+  sent.push_back(2);
+  return true;
+}
+bool request_3() {
+  sent.push_back(3);
+  return false;
+}
+
+void add_requests(TionPollCycle &poll) {
+  poll.begin();
+  poll.add(0x11, TionPollCycle::request_type::create<request_1>());
+  poll.add(0x12, TionPollCycle::request_type::create<request_2>());
+  poll.add(0x13, TionPollCycle::request_type::create<request_3>());
+}
+
+bool test_api_poll() {
+  bool res = true;
+
+  sent.clear();
+  esphome::test_set_millis(1000);
+
+  TionPollCycle poll;
+  poll.set_window(1);
+  add_requests(poll);
+  poll.start();
+  res &= cloak::check_data("window 1", uint32_t(sent.size()), 1u);
+  res &= cloak::check_data("unexpected frame", poll.on_frame(0x12), false);
+  esphome::test_set_millis(1040);
+  res &= cloak::check_data("response 1", poll.on_frame(0x11), true);
+  res &= cloak::check_data("sent 2", uint32_t(sent.size()), 2u);
+  esphome::test_set_millis(1100);
+  // failed request 3 is not waited for
+  poll.on_frame(0x12);
+  res &= cloak::check_data("sent 3", uint32_t(sent.size()), 3u);
+  res &= cloak::check_data("completed", poll.is_active(), false);
+  res &= cloak::check_data("cycle time", poll.get_cycle_time(), 100u);
+
+  sent.clear();
+  poll.set_window(2);
+  add_requests(poll);
+  poll.start();
+  res &= cloak::check_data("window 2", uint32_t(sent.size()), 2u);
+  poll.on_frame(0x12);
+  res &= cloak::check_data("out of order", uint32_t(sent.size()), 3u);
+  res &= cloak::check_data("active", poll.is_active(), true);
+
+  add_requests(poll);
+  res &= cloak::check_data("incomplete", poll.get_incomplete(), 1u);
+
+  // lost response does not stall the cycle
+  sent.clear();
+  poll.set_window(1);
+  poll.start();
+  esphome::test_set_millis(1000 + TionPollCycle::STEP_TIMEOUT - 1);
+  poll.loop();
+  res &= cloak::check_data("waiting", uint32_t(sent.size()), 1u);
+  esphome::test_set_millis(1100 + TionPollCycle::STEP_TIMEOUT);
+  poll.loop();
+  res &= cloak::check_data("skipped", poll.get_skipped(), 1u);
+  res &= cloak::check_data("sent after skip", uint32_t(sent.size()), 2u);
+  poll.on_frame(0x12);
+  res &= cloak::check_data("completed after skip", poll.is_active(), false);
+
+  return res;
+}
+
+// Api writes through the TX queue to the wire like TionVPortApi does.
+class WireTest {
+ public:
+  WireTest(uint8_t window, uint8_t queue_window) {
+    this->api.set_writer(Tion4sApi::writer_type::create<WireTest, &WireTest::write_>(*this));
+    this->queue.set_writer(TionTxQueue::writer_type::create<WireTest, &WireTest::transmit_>(*this));
+    this->queue.set_policy(Tion4sApi::get_tx_policy);
+    this->api.set_poll_window(window);
+    this->queue.set_window(queue_window);
+  }
+
+  Tion4sApi api;
+  TionTxQueue queue;
+  std::vector<uint16_t> wire;
+
+ protected:
+  bool write_(uint16_t type, const void *data, size_t size) { return this->queue.write(type, data, size); }
+  bool transmit_(uint16_t type, const void *data, size_t size) {
+    this->wire.push_back(type);
+    return true;
+  }
+};
+
+bool test_api_poll_wire() {
+  bool res = true;
+
+  esphome::test_set_millis(1000);
+
+  // dev info and state requests of the first cycle are serialized by the queue waiting for a single response
+  WireTest serial(2, 1);
+  serial.api.request_state();
+  res &= cloak::check_data("queue window 1 wire", uint32_t(serial.wire.size()), 1u);
+  res &= cloak::check_data("queue window 1 queued", uint32_t(serial.queue.size()), 1u);
+
+  // TionVPortApi sets queue window to poll window
+  WireTest pipelined(2, 2);
+  pipelined.api.request_state();
+  res &= cloak::check_data("window 2 wire", uint32_t(pipelined.wire.size()), 2u);
+  res &= cloak::check_data("window 2 pending", uint32_t(pipelined.queue.get_pending()), 2u);
+  res &= cloak::check_data("window 2 state", uint32_t(pipelined.wire.back()),
+                           uint32_t(dentra::tion_4s::FRAME_TYPE_STATE_REQ));
+
+  // a response releases a single frame
+  pipelined.queue.on_frame();
+  res &= cloak::check_data("window 2 released", uint32_t(pipelined.queue.get_pending()), 1u);
+
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_api_poll);
+REGISTER_TEST(test_api_poll_wire);
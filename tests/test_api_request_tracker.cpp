@@ -0,0 +1,99 @@
+#include <cstring>
+#include <vector>
+
+#include "esphome/core/helpers.h"
+
+#include "../components/tion-api/tion-api-4s.h"
+#include "../components/tion-api/tion-api-request-tracker.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using dentra::tion::TionRequestTracker;
+using dentra::tion_4s::Tion4sApi;
+using namespace dentra::tion_4s;
+
+namespace {
+
+std::vector<uint16_t> tx_types;
+bool write_frame(uint16_t type, const void *data, size_t size) {
+  tx_types.push_back(type);
+  return true;
+}
+
+bool complete(TionRequestTracker &tr, uint16_t type, uint32_t request_id) {
+  return tr.complete(type, &request_id, sizeof(request_id));
+}
+
+void track(TionRequestTracker &tr, uint16_t type, uint32_t request_id) {
+  tr.track(type, &request_id, sizeof(request_id));
+}
+
+bool test_api_request_tracker() {
+  bool res = true;
+
+  tx_types.clear();
+  esphome::test_set_millis(1000);
+
+  TionRequestTracker tr;
+  tr.set_writer(TionRequestTracker::writer_type::create<write_frame>());
+  tr.set_request_info(Tion4sApi::get_request_info);
+  tr.set_response_id(Tion4sApi::get_response_id);
+
+  // state request without id is completed by any state response
+  tr.track(FRAME_TYPE_STATE_REQ, nullptr, 0);
+  esphome::test_set_millis(1100);
+  res &= cloak::check_data("state", complete(tr, FRAME_TYPE_STATE_RSP, 1), true);
+
+  // write state is completed only by the response with its id
+  track(tr, FRAME_TYPE_STATE_SET, 5);
+  track(tr, FRAME_TYPE_TIME_REQ, 6);
+  res &= cloak::check_data("unsolicited", complete(tr, FRAME_TYPE_STATE_RSP, 1), false);
+  res &= cloak::check_data("write state", complete(tr, FRAME_TYPE_STATE_RSP, 5), true);
+  res &= cloak::check_data("in flight", uint32_t(tr.size()), 1u);
+
+  // lost idempotent request is resent once
+  esphome::test_set_millis(1100 + TionRequestTracker::REQUEST_TIMEOUT);
+  tr.loop();
+  res &= cloak::check_data("resent", uint32_t(tx_types.size()), 1u);
+  res &= cloak::check_data("resent type", uint32_t(tx_types.size() ? tx_types[0] : 0), uint32_t(FRAME_TYPE_TIME_REQ));
+  esphome::test_set_millis(1100 + TionRequestTracker::REQUEST_TIMEOUT * 2);
+  tr.loop();
+  res &= cloak::check_data("timed out", uint32_t(tr.size()), 0u);
+  res &= cloak::check_data("link alive", tr.is_link_lost(), false);
+
+  // lost link
+  for (uint32_t i = 0; i < TionRequestTracker::LINK_LOST_TIMEOUTS; i++) {
+    track(tr, FRAME_TYPE_STATE_SET, 10 + i);
+  }
+  esphome::test_set_millis(1100 + TionRequestTracker::REQUEST_TIMEOUT * 3);
+  tr.loop();
+  res &= cloak::check_data("link lost", tr.is_link_lost(), true);
+
+  // frames without response are not tracked
+  tr.track(FRAME_TYPE_STATE_SAV, nullptr, 0);
+  res &= cloak::check_data("not tracked", uint32_t(tr.size()), 0u);
+
+  // rtt
+  for (uint32_t rtt : {10, 20, 20, 30, 300}) {
+    tr.track(FRAME_TYPE_DEV_INFO_REQ, nullptr, 0);
+    esphome::test_set_millis(esphome::millis() + rtt);
+    tr.complete(FRAME_TYPE_DEV_INFO_RSP, nullptr, 0);
+  }
+  res &= cloak::check_data("link restored", tr.is_link_lost(), false);
+  res &= cloak::check_data("rtt p50", tr.get_rtt_percentile(FRAME_TYPE_DEV_INFO_RSP, 50), 32u);
+  res &= cloak::check_data("rtt p95", tr.get_rtt_percentile(FRAME_TYPE_DEV_INFO_RSP, 95), 512u);
+  res &= cloak::check_data("rtt none", tr.get_rtt_percentile(FRAME_TYPE_TIME_RSP, 50), 0u);
+
+  const auto &stats = tr.get_stats();
+  res &= cloak::check_data("stats.completed", stats.completed, 7u);
+  res &= cloak::check_data("stats.retries", stats.retries, 1u);
+  res &= cloak::check_data("stats.timeouts", stats.timeouts, 4u);
+
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_api_request_tracker);
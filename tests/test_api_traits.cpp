@@ -0,0 +1,53 @@
+#include "esphome/core/helpers.h"
+
+#include "../components/tion-api/tion-api-3s.h"
+#include "../components/tion-api/tion-api-4s.h"
+#include "../components/tion-api/tion-api-lt.h"
+#include "../components/tion-api/tion-api-o2.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using namespace dentra::tion;
+
+namespace {
+
+using Merged = TionMergedTraits<Tion3sStaticTraits, TionLtStaticTraits>;
+static_assert((Merged::SUPPORTED & FEATURE_GATE_POSITION_CHANGE_MIXED) != 0, "3S feature must be supported");
+static_assert((Merged::DYNAMIC & FEATURE_GATE_POSITION_CHANGE_MIXED) != 0, "3S only feature must be dynamic");
+static_assert((Merged::DYNAMIC & FEATURE_SOUND_STATE) == 0, "common feature must be static");
+static_assert((Merged::SUPPORTED & FEATURE_BOOST) == 0, "unused feature must be unsupported");
+
+// Runtime traits of the model must match its static traits.
+template<class api_t> bool check_static_traits(const char *name) {
+  using static_traits = typename api_t::static_traits_type;
+  api_t api;
+  const auto &traits = api.get_traits();
+  uint32_t features = 0;
+  for (uint32_t feature = 1; feature & FEATURE_ALL; feature <<= 1) {
+    if (traits.has_feature(static_cast<TionFeature>(feature))) {
+      features |= feature;
+    }
+  }
+  bool res = true;
+  res &= cloak::check_data(std::string(name) + " unsupported", features & ~static_traits::SUPPORTED, 0u);
+  res &= cloak::check_data(std::string(name) + " static", features & ~static_traits::DYNAMIC,
+                           static_traits::SUPPORTED & ~static_traits::DYNAMIC);
+  res &= cloak::check_data(std::string(name) + " supports", traits.template supports<FEATURE_SOUND_STATE>(),
+                           traits.supports_sound_state);
+  return res;
+}
+
+bool test_api_traits() {
+  bool res = true;
+  res &= check_static_traits<Tion3sApi>("3s");
+  res &= check_static_traits<dentra::tion_4s::Tion4sApi>("4s");
+  res &= check_static_traits<TionLtApi>("lt");
+  res &= check_static_traits<dentra::tion_o2::TionO2Api>("o2");
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_api_traits);
@@ -0,0 +1,141 @@
+#include <vector>
+
+#include "esphome/core/helpers.h"
+
+#include "../components/tion-api/tion-api-tx-queue.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using dentra::tion::TionTxPolicy;
+using dentra::tion::TionTxQueue;
+
+namespace {
+
+enum : uint16_t {
+  TYPE_STATE_SET = 1,
+  TYPE_STATE_REQ = 2,
+  TYPE_HEARTBEAT = 3,
+  TYPE_TIME_SET = 4,
+  TYPE_RESET = 5,
+};
+
+std::vector<uint16_t> tx_types;
+std::vector<uint8_t> tx_data;
+bool write_frame(uint16_t type, const void *data, size_t size) {
+  tx_types.push_back(type);
+  if (size > 0) {
+    tx_data.push_back(*static_cast<const uint8_t *>(data));
+  }
+  return true;
+}
+
+TionTxPolicy get_tx_policy(uint16_t type, const void * /*data*/, size_t /*size*/) {
+  switch (type) {
+    case TYPE_STATE_SET:
+      return dentra::tion::TX_POLICY_LATEST;
+    case TYPE_HEARTBEAT:
+      return dentra::tion::TX_POLICY_PRIORITY;
+    case TYPE_TIME_SET:
+      return dentra::tion::TX_POLICY_NO_RESPONSE;
+    default:
+      return dentra::tion::TX_POLICY_FIFO;
+  }
+}
+
+bool write(TionTxQueue &q, uint16_t type, uint8_t value) { return q.write(type, &value, sizeof(value)); }
+
+bool test_api_tx_queue() {
+  bool res = true;
+
+  tx_types.clear();
+  tx_data.clear();
+  esphome::test_set_millis(1000);
+
+  TionTxQueue q;
+  q.set_writer(TionTxQueue::writer_type::create<write_frame>());
+  q.set_policy(get_tx_policy);
+
+  // sent immediately, awaits a response
+  q.write(TYPE_STATE_REQ, nullptr, 0);
+  res &= cloak::check_data("pending", q.is_pending(), true);
+
+  // ui burst while response is pending, state set is merged across the request
+  write(q, TYPE_STATE_SET, 1);
+  write(q, TYPE_STATE_SET, 2);
+  q.write(TYPE_STATE_REQ, nullptr, 0);
+  q.write(TYPE_STATE_REQ, nullptr, 0);
+  write(q, TYPE_STATE_SET, 3);
+  write(q, TYPE_HEARTBEAT, 0);
+  res &= cloak::check_data("sent before response", uint32_t(tx_types.size()), 1u);
+  res &= cloak::check_data("queued", uint32_t(q.size()), 3u);
+
+  q.on_frame();
+  res &= cloak::check_data("heartbeat first", uint32_t(tx_types.back()), uint32_t(TYPE_HEARTBEAT));
+  q.on_frame();
+  res &= cloak::check_data("newest state", uint32_t(tx_data.back()), 3u);
+  q.on_frame();
+  res &= cloak::check_data("request", uint32_t(tx_types.back()), uint32_t(TYPE_STATE_REQ));
+  q.on_frame();
+  res &= cloak::check_data("empty", uint32_t(q.size()), 0u);
+  res &= cloak::check_data("released", q.is_pending(), false);
+
+  // toggles are not deduplicated
+  write(q, TYPE_RESET, 1);
+  write(q, TYPE_RESET, 0);
+  write(q, TYPE_RESET, 1);
+  q.loop();
+  res &= cloak::check_data("wait response", uint32_t(q.size()), 2u);
+  // response timeout
+  esphome::test_set_millis(1000 + TionTxQueue::RESPONSE_TIMEOUT);
+  q.loop();
+  res &= cloak::check_data("sent after timeout", uint32_t(tx_data.back()), 0u);
+  q.on_frame();
+  res &= cloak::check_data("last toggle", uint32_t(tx_data.back()), 1u);
+  q.on_frame();
+
+  // frames without response are not delayed
+  write(q, TYPE_TIME_SET, 1);
+  write(q, TYPE_TIME_SET, 2);
+  res &= cloak::check_data("no response", uint32_t(tx_data.back()), 2u);
+
+  const auto &stats = q.get_tx_stats();
+  res &= cloak::check_data("stats.sent", stats.sent, 9u);
+  res &= cloak::check_data("stats.coalesced", stats.coalesced, 2u);
+  res &= cloak::check_data("stats.deduped", stats.deduped, 1u);
+  res &= cloak::check_data("stats.timeouts", stats.timeouts, 1u);
+
+  // large frame is sent when nothing is pending and waits for a response like others
+  const uint8_t large[TionTxQueue::DATA_MAX_SIZE + 1]{};
+  res &= cloak::check_data("large sent", q.write(TYPE_RESET, large, sizeof(large)), true);
+  res &= cloak::check_data("large pending", q.is_pending(), true);
+  // but it is never queued
+  res &= cloak::check_data("large rejected", q.write(TYPE_RESET, large, sizeof(large)), false);
+  res &= cloak::check_data("stats.rejected", stats.rejected, 1u);
+  q.on_frame();
+
+  // window lets several frames wait for responses
+  tx_types.clear();
+  q.set_window(2);
+  q.write(TYPE_STATE_REQ, nullptr, 0);
+  q.write(TYPE_RESET, nullptr, 0);
+  q.write(TYPE_STATE_REQ, nullptr, 0);
+  res &= cloak::check_data("window sent", uint32_t(tx_types.size()), 2u);
+  q.on_frame();
+  res &= cloak::check_data("window next", uint32_t(tx_types.size()), 3u);
+  // half-duplex link always waits for a single response
+  q.set_half_duplex(true);
+  res &= cloak::check_data("half-duplex window", uint32_t(q.get_window()), 1u);
+  q.on_frame();
+  q.on_frame();
+  q.write(TYPE_STATE_REQ, nullptr, 0);
+  q.write(TYPE_RESET, nullptr, 0);
+  res &= cloak::check_data("half-duplex sent", uint32_t(tx_types.size()), 4u);
+
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_api_tx_queue);
@@ -0,0 +1,242 @@
+#include <vector>
+
+#include "esphome/components/uart/uart_component.h"
+
+#include "../components/tion-api/tion-api-3s-internal.h"
+#include "../components/tion-api/tion-api-4s-internal.h"
+#include "../components/tion-api/tion-api-o2-internal.h"
+#include "../components/tion-api/tion-api-uart-3s.h"
+#include "../components/tion-api/tion-api-uart-4s.h"
+#include "../components/tion-api/tion-api-uart-o2.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using esphome::uart::UARTComponent;
+using dentra::tion::Tion3sUartProtocol;
+using dentra::tion::Tion4sUartProtocol;
+using dentra::tion_o2::TionO2UartProtocol;
+
+namespace {
+
+class TestTionUartReader : public dentra::tion::TionUartReader {
+ public:
+  TestTionUartReader(UARTComponent *uart) : uart_(uart) {}
+  int available() override { return this->uart_->available(); }
+  bool read_array(void *data, size_t size) override { return this->uart_->read_array(data, size); }
+
+ protected:
+  UARTComponent *uart_;
+};
+
+std::vector<uint8_t> tx_data;
+bool write_data(const uint8_t *data, size_t size) {
+  tx_data.insert(tx_data.end(), data, data + size);
+  return true;
+}
+
+std::vector<uint16_t> rx_types;
+std::vector<size_t> rx_sizes;
+template<class P> void read_frame(const typename P::frame_spec_type &frame, size_t size) {
+  rx_types.push_back(frame.type);
+  rx_sizes.push_back(size);
+}
+
+template<class P> std::vector<uint8_t> make_frame(uint16_t type, const std::vector<uint8_t> &data) {
+  tx_data.clear();
+  P pr;
+  pr.writer = P::writer_type::template create<write_data>();
+  pr.write_frame(type, data.data(), data.size());
+  return tx_data;
+}
+
+template<class P> void read_uart_data(P &pr, const std::vector<uint8_t> &rx) {
+  UARTComponent uart(rx.data(), rx.size());
+  TestTionUartReader io(&uart);
+  for (int i = 0; i < 100; i++) {
+    pr.read_uart_data(&io);
+  }
+}
+
+bool test_api_uart_4s() {
+  bool res = true;
+
+  const auto frame1 = make_frame<Tion4sUartProtocol>(dentra::tion_4s::FRAME_TYPE_STATE_REQ, {});
+  const auto frame2 = make_frame<Tion4sUartProtocol>(dentra::tion_4s::FRAME_TYPE_DEV_INFO_REQ, {0x01, 0x02, 0x03});
+  auto broken = frame2;
+  broken[broken.size() - 1] ^= 0xFF;
+
+  std::vector<uint8_t> rx;
+  // noise before the first frame
+  rx.insert(rx.end(), {0x00, 0x11, 0x22});
+  rx.insert(rx.end(), frame1.begin(), frame1.end());
+  // broken frame followed by a valid one must be resynced without data loss
+  rx.insert(rx.end(), broken.begin(), broken.end());
+  rx.insert(rx.end(), frame2.begin(), frame2.end());
+  // repeat to make frames wrap around the ring buffer
+  constexpr uint32_t repeats = 30;
+  for (uint32_t i = 0; i < repeats; i++) {
+    rx.insert(rx.end(), frame1.begin(), frame1.end());
+  }
+
+  rx_types.clear();
+  rx_sizes.clear();
+
+  Tion4sUartProtocol pr;
+  pr.reader = Tion4sUartProtocol::reader_type::create<read_frame<Tion4sUartProtocol>>();
+
+  UARTComponent uart(rx.data(), rx.size());
+  TestTionUartReader io(&uart);
+  for (int i = 0; i < 1000; i++) {
+    pr.read_uart_data(&io);
+  }
+
+  const auto &stats = pr.get_rx_stats();
+  res &= cloak::check_data("frames", uint32_t(rx_types.size()), 2 + repeats);
+  res &= cloak::check_data("frames[1]", uint32_t(rx_types.size() > 1 ? rx_types[1] : 0),
+                           uint32_t(dentra::tion_4s::FRAME_TYPE_DEV_INFO_REQ));
+  res &= cloak::check_data("sizes[1]", uint32_t(rx_sizes.size() > 1 ? rx_sizes[1] : 0), 2u + 3u);
+  res &= cloak::check_data("stats.frames", stats.frames, 2 + repeats);
+  res &= cloak::check_data("stats.crc_errors", stats.crc_errors, 1u);
+  res &= cloak::check_data("stats.resyncs", stats.resyncs, 2u);
+  res &= cloak::check_data("stats.dropped", stats.dropped, uint32_t(3 + broken.size()));
+  res &= cloak::check_data("stats.last_dropped", uint32_t(stats.last_dropped), uint32_t(broken.size()));
+
+  return res;
+}
+
+bool test_api_uart_3s() {
+  bool res = true;
+
+  using namespace dentra::tion_3s;
+  const auto frame1 = make_frame<Tion3sUartProtocol>(FRAME_TYPE_REQ(FRAME_TYPE_STATE_GET), {});
+  const auto frame2 = make_frame<Tion3sUartProtocol>(FRAME_TYPE_RSP(FRAME_TYPE_STATE_GET), {0x01, 0x02});
+  auto broken = frame2;
+  broken[broken.size() - 1] ^= 0xFF;
+
+  std::vector<uint8_t> rx;
+  // request frame is a noise for the response reader
+  rx.insert(rx.end(), frame1.begin(), frame1.end());
+  rx.insert(rx.end(), broken.begin(), broken.end());
+  rx.insert(rx.end(), frame2.begin(), frame2.end());
+
+  rx_types.clear();
+  rx_sizes.clear();
+
+  Tion3sUartProtocol pr;
+  pr.reader = Tion3sUartProtocol::reader_type::create<read_frame<Tion3sUartProtocol>>();
+  read_uart_data(pr, rx);
+
+  res &= cloak::check_data("frames", uint32_t(rx_types.size()), 1u);
+  res &= cloak::check_data("frames[0]", uint32_t(rx_types.size() > 0 ? rx_types[0] : 0),
+                           uint32_t(FRAME_TYPE_RSP(FRAME_TYPE_STATE_GET)));
+  res &= cloak::check_data("sizes[0]", uint32_t(rx_sizes.size() > 0 ? rx_sizes[0] : 0), 19u);
+  res &= cloak::check_data("stats.crc_errors", pr.get_rx_stats().crc_errors, 1u);
+  res &= cloak::check_data("stats.dropped", pr.get_rx_stats().dropped, uint32_t(frame1.size() + broken.size()));
+
+  return res;
+}
+
+bool test_api_uart_o2() {
+  bool res = true;
+
+  const auto frame1 = cloak::from_hex("11 0C 0C 13 10 02 3C 04 00 00 B4 D6 DC 01 01 F6 CA 01 54");
+  const auto frame2 = make_frame<TionO2UartProtocol>(dentra::tion_o2::FRAME_TYPE_DEV_MODE_RSP, {0x00});
+  auto broken = frame2;
+  broken[broken.size() - 1] ^= 0xFF;
+
+  rx_types.clear();
+  rx_sizes.clear();
+
+  TionO2UartProtocol pr;
+  pr.reader = TionO2UartProtocol::reader_type::create<read_frame<TionO2UartProtocol>>();
+  // O2 has no magic, so data received after an invalid frame is dropped until the next receive
+  read_uart_data(pr, {0x00, 0xFF});
+  std::vector<uint8_t> rx(frame1);
+  rx.insert(rx.end(), broken.begin(), broken.end());
+  rx.insert(rx.end(), frame2.begin(), frame2.end());
+  read_uart_data(pr, rx);
+  read_uart_data(pr, frame2);
+
+  res &= cloak::check_data("frames", uint32_t(rx_types.size()), 2u);
+  res &= cloak::check_data("frames[0]", uint32_t(rx_types.size() > 0 ? rx_types[0] : 0),
+                           uint32_t(dentra::tion_o2::FRAME_TYPE_STATE_GET_RSP));
+  res &= cloak::check_data("sizes[0]", uint32_t(rx_sizes.size() > 0 ? rx_sizes[0] : 0), uint32_t(frame1.size() - 1));
+  res &= cloak::check_data("frames[1]", uint32_t(rx_types.size() > 1 ? rx_types[1] : 0),
+                           uint32_t(dentra::tion_o2::FRAME_TYPE_DEV_MODE_RSP));
+  res &= cloak::check_data("stats.crc_errors", pr.get_rx_stats().crc_errors, 1u);
+  res &= cloak::check_data("stats.dropped", pr.get_rx_stats().dropped, uint32_t(2 + broken.size() + frame2.size()));
+
+  return res;
+}
+
+bool test_api_uart_o2_noise() {
+  bool res = true;
+
+  const auto frame = make_frame<TionO2UartProtocol>(dentra::tion_o2::FRAME_TYPE_DEV_MODE_RSP, {0x00});
+
+  rx_types.clear();
+  rx_sizes.clear();
+
+  TionO2UartProtocol pr;
+  pr.reader = TionO2UartProtocol::reader_type::create<read_frame<TionO2UartProtocol>>();
+
+  // line noise followed by a valid frame in the same receive
+  uint32_t seed = 12345;
+  constexpr uint32_t bursts = 200;
+  for (uint32_t i = 0; i < bursts; i++) {
+    std::vector<uint8_t> rx;
+    for (int j = 0; j < 16; j++) {
+      seed = seed * 1103515245 + 12345;
+      rx.push_back(seed >> 16);
+    }
+    rx.insert(rx.end(), frame.begin(), frame.end());
+    read_uart_data(pr, rx);
+  }
+  const uint32_t noise_frames = rx_types.size();
+
+  // clean frame after noise is received
+  read_uart_data(pr, frame);
+
+  res &= cloak::check_data("noise frames", noise_frames < bursts / 50, true);
+  res &= cloak::check_data("frame after noise", uint32_t(rx_types.size()), noise_frames + 1);
+  res &= cloak::check_data("frame type", uint32_t(rx_types.back()), uint32_t(dentra::tion_o2::FRAME_TYPE_DEV_MODE_RSP));
+
+  return res;
+}
+
+template<class P> bool test_lease_frame(const char *name, uint16_t type) {
+  const std::vector<uint8_t> data{0x01, 0x02, 0x03};
+  const auto expected = make_frame<P>(type, data);
+
+  tx_data.clear();
+  P pr;
+  pr.writer = P::writer_type::template create<write_data>();
+  auto *frame = pr.lease_frame(data.size());
+  if (frame == nullptr) {
+    return cloak::check_data(name, false, true);
+  }
+  std::copy(data.begin(), data.end(), frame->data);
+  pr.write_frame(type, frame->data, data.size());
+
+  bool res = cloak::check_data(name, tx_data, expected);
+  res &= cloak::check_data("lease too large", pr.lease_frame(1000) == nullptr, true);
+  return res;
+}
+
+bool test_api_uart_lease() {
+  bool res = true;
+  res &= test_lease_frame<Tion4sUartProtocol>("4s", dentra::tion_4s::FRAME_TYPE_STATE_SET);
+  res &= test_lease_frame<Tion3sUartProtocol>("3s", FRAME_TYPE(dentra::tion_3s::FRAME_MAGIC_REQ, 2));
+  res &= test_lease_frame<TionO2UartProtocol>("o2", dentra::tion_o2::FRAME_TYPE_STATE_SET_REQ);
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_api_uart_4s);
+REGISTER_TEST(test_api_uart_3s);
+REGISTER_TEST(test_api_uart_o2);
+REGISTER_TEST(test_api_uart_o2_noise);
+REGISTER_TEST(test_api_uart_lease);
@@ -0,0 +1,161 @@
+#include "esphome/core/helpers.h"
+
+#include "../components/tion-api/tion-api-3s.h"
+#include "../components/tion-api/tion-api-3s-internal.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using dentra::tion::Tion3sApi;
+using dentra::tion::TionApiBase;
+using dentra::tion::TionState;
+using dentra::tion::TionStateCall;
+using namespace dentra::tion_3s;
+
+namespace {
+
+uint32_t state_set_frames{};
+bool write_frame(uint16_t type, const void *data, size_t size) {
+  if (type == FRAME_TYPE_REQ(FRAME_TYPE_STATE_SET)) {
+    state_set_frames++;
+  }
+  return true;
+}
+
+void read_state(Tion3sApi &api, uint8_t fan_speed) {
+  tion3s_state_t st{};
+  st.fan_speed = fan_speed;
+  st.gate_position = tion3s_state_t::GATE_POSITION_OUTDOOR;
+  st.target_temperature = 20;
+  st.flags.power_state = true;
+  api.read_frame(FRAME_TYPE_RSP(FRAME_TYPE_STATE_GET), &st, sizeof(st));
+}
+
+void set_fan_speed(Tion3sApi &api, uint8_t fan_speed) {
+  TionStateCall call(&api);
+  call.set_fan_speed(fan_speed);
+  call.set_power_state(true);
+  call.perform();
+}
+
+/// Breezer with request id in responses like 4S and Lite.
+class IdApi : public TionApiBase {
+ public:
+  IdApi() { this->traits_ = Tion3sApi().get_traits(); }
+
+  void request_state() override {}
+  void write_state(TionStateCall *call) override {
+    const auto state = this->make_write_state_(call);
+    if (this->write_suppressed_(state)) {
+      return;
+    }
+    this->writes++;
+    this->state_written_(state, this->next_request_id_());
+  }
+  void reset_filter() override {}
+
+  void read_state(uint8_t fan_speed, uint32_t request_id) {
+    this->state_.initialized = true;
+    this->state_.power_state = true;
+    this->state_.fan_speed = fan_speed;
+    this->notify_state_(request_id);
+  }
+
+  uint32_t writes{};
+
+ protected:
+  bool write_retry_(const TionState &state, uint32_t request_id) override {
+    this->writes++;
+    return true;
+  }
+};
+
+bool test_api_write_verify_lost() {
+  bool res = true;
+
+  esphome::test_set_millis(1000);
+
+  IdApi api;
+  api.read_state(2, 1);
+
+  // response to the write is lost, the next poll is decisive
+  TionStateCall call(&api);
+  call.set_fan_speed(4);
+  call.set_power_state(true);
+  call.perform();
+  res &= cloak::check_data("written", api.writes, 1u);
+  api.read_state(2, 1);
+  res &= cloak::check_data("outdated", api.writes, 1u);
+  api.read_state(2, 1);
+  res &= cloak::check_data("retry", api.writes, 2u);
+  api.read_state(4, 1);
+  res &= cloak::check_data("verified", api.get_verify_fields(), 0u);
+
+  // no responses at all, verification expires
+  call.set_fan_speed(5);
+  call.perform();
+  res &= cloak::check_data("written again", api.writes, 3u);
+  esphome::test_set_millis(1000 + TionApiBase::WRITE_VERIFY_TIMEOUT + 1);
+  api.loop();
+  res &= cloak::check_data("expired", api.get_verify_fields(), 0u);
+  res &= cloak::check_data("expired stats", api.get_write_stats().verify_failed, 1u);
+  // the same command is not suppressed by the stale target
+  call.set_fan_speed(5);
+  call.perform();
+  res &= cloak::check_data("not suppressed", api.writes, 4u);
+
+  return res;
+}
+
+bool test_api_write_verify() {
+  bool res = true;
+
+  Tion3sApi api;
+  api.set_writer(Tion3sApi::writer_type::create<write_frame>());
+
+  // nothing to compare with before the first state
+  set_fan_speed(api, 2);
+  res &= cloak::check_data("not initialized", state_set_frames, 1u);
+
+  read_state(api, 2);
+  set_fan_speed(api, 2);
+  res &= cloak::check_data("suppressed", state_set_frames, 1u);
+  res &= cloak::check_data("suppressed stats", api.get_write_stats().suppressed, 1u);
+
+  // applied write is verified by the next state
+  set_fan_speed(api, 3);
+  res &= cloak::check_data("written", state_set_frames, 2u);
+  res &= cloak::check_data("verify", api.get_verify_fields(), uint32_t(dentra::tion::STATE_FIELD_FAN_SPEED));
+  // repeated call while the write is not verified yet
+  set_fan_speed(api, 3);
+  res &= cloak::check_data("in flight", state_set_frames, 2u);
+  read_state(api, 3);
+  res &= cloak::check_data("verified", api.get_verify_fields(), 0u);
+
+  // not applied write is retried, the first state may be requested before the write
+  set_fan_speed(api, 4);
+  read_state(api, 3);
+  res &= cloak::check_data("outdated", state_set_frames, 3u);
+  read_state(api, 3);
+  res &= cloak::check_data("retry", state_set_frames, 4u);
+  res &= cloak::check_data("retry stats", api.get_write_stats().retries, 1u);
+  read_state(api, 4);
+  res &= cloak::check_data("retry verified", api.get_verify_fields(), 0u);
+
+  // retries are bounded
+  set_fan_speed(api, 5);
+  for (int i = 0; i < (TionApiBase::WRITE_MAX_RETRIES + 1) * 2; i++) {
+    read_state(api, 4);
+  }
+  res &= cloak::check_data("failed", state_set_frames, 5u + TionApiBase::WRITE_MAX_RETRIES);
+  res &= cloak::check_data("failed stats", api.get_write_stats().verify_failed, 1u);
+  res &= cloak::check_data("failed verify", api.get_verify_fields(), 0u);
+
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_api_write_verify);
+REGISTER_TEST(test_api_write_verify_lost);
@@ -0,0 +1,250 @@
+#include "../components/tion/tion_component.h"
+#include "../components/tion/tion_properties.h"
+
+#include "utils.h"
+
+DEFINE_TAG;
+
+using namespace esphome::tion;
+using namespace dentra::tion;
+
+namespace {
+
+class TestTionApiComponent : public TionApiComponent {
+ public:
+  using TionApiComponent::TionApiComponent;
+  void test_notify_state(uint32_t changes) { this->notify_state_(&this->state(), changes); }
+  void test_state_lost() { this->notify_state_(nullptr, STATE_FIELD_ALL); }
+  void test_state_timeout() { this->state_lost_(); }
+  void test_state(uint32_t changes) { this->on_state_(this->state(), changes, 0); }
+  void test_write() { this->poll_fast_start_(); }
+  void test_state_check(uint16_t state_type) {
+    this->state_type_ = state_type;
+    this->state_check_schedule_();
+  }
+};
+
+bool test_component_subscribers() {
+  bool res = true;
+
+  Tion3sApi api;
+  TestTionApiComponent c(&api);
+
+  int fan_speed = 0;
+  int power = 0;
+  int any = 0;
+  int lost = 0;
+  c.add_on_state_callback(property_controller::Controller<property_controller::sensor::FanSpeed>::state_fields(),
+                          [&](const TionState *state) { state ? fan_speed++ : lost++; });
+  c.add_on_state_callback(property_controller::Controller<property_controller::sensor::Power>::state_fields(),
+                          [&](const TionState *state) { state ? power++ : lost++; });
+  c.add_on_state_callback(property_controller::Controller<property_controller::binary_sensor::State>::state_fields(),
+                          [&](const TionState *state) { state ? any++ : lost++; });
+
+  c.test_notify_state(STATE_FIELD_WORK_TIME | STATE_FIELD_AIRFLOW);
+  res &= cloak::check_data("counters.fan_speed", fan_speed, 0);
+  res &= cloak::check_data("counters.power", power, 0);
+  res &= cloak::check_data("counters.any", any, 1);
+
+  // power depends on both changed fields, but is called once
+  c.test_notify_state(STATE_FIELD_POWER | STATE_FIELD_FAN_SPEED | STATE_FIELD_HEATER_VAR);
+  res &= cloak::check_data("power.fan_speed", fan_speed, 1);
+  res &= cloak::check_data("power.power", power, 1);
+
+  c.test_notify_state(STATE_FIELD_HEATER_VAR);
+  res &= cloak::check_data("heater.fan_speed", fan_speed, 1);
+  res &= cloak::check_data("heater.power", power, 2);
+
+  c.test_state_lost();
+  res &= cloak::check_data("lost", lost, 3);
+
+  return res;
+}
+
+bool test_component_adaptive_poll() {
+  bool res = true;
+
+  Tion3sApi api;
+  TestTionApiComponent c(&api);
+  c.set_update_interval(10000);
+  c.set_adaptive_interval(4000, 60000);
+
+  res &= cloak::check_data("initial", c.get_poll_interval(), 10000u);
+
+  // fast polls after a write
+  c.test_write();
+  res &= cloak::check_data("write", c.get_poll_interval(), 4000u);
+  c.test_state(STATE_FIELD_FAN_SPEED);
+  c.test_state(STATE_FIELD_WORK_TIME);
+  c.test_state(STATE_FIELD_WORK_TIME);
+  res &= cloak::check_data("write.fast", c.get_poll_interval(), 4000u);
+  c.test_state(STATE_FIELD_WORK_TIME);
+  res &= cloak::check_data("write.done", c.get_poll_interval(), 10000u);
+
+  // back off when nothing is changed
+  c.test_state(STATE_FIELD_WORK_TIME);
+  c.test_state(STATE_FIELD_WORK_TIME);
+  res &= cloak::check_data("idle.3", c.get_poll_interval(), 20000u);
+  for (int i = 0; i < 3; i++) {
+    c.test_state(STATE_FIELD_WORK_TIME | STATE_FIELD_AIRFLOW);
+  }
+  res &= cloak::check_data("idle.6", c.get_poll_interval(), 40000u);
+  for (int i = 0; i < 6; i++) {
+    c.test_state(STATE_FIELD_WORK_TIME);
+  }
+  res &= cloak::check_data("idle.max", c.get_poll_interval(), 60000u);
+
+  c.test_state(STATE_FIELD_TARGET_TEMPERATURE);
+  res &= cloak::check_data("changed", c.get_poll_interval(), 10000u);
+
+  // state timeout resets back off
+  for (int i = 0; i < 12; i++) {
+    c.test_state(STATE_FIELD_WORK_TIME);
+  }
+  res &= cloak::check_data("lost.before", c.get_poll_interval(), 60000u);
+  c.test_state_timeout();
+  res &= cloak::check_data("lost", c.get_poll_interval(), 10000u);
+  c.test_state(STATE_FIELD_WORK_TIME);
+  res &= cloak::check_data("lost.restored", c.get_poll_interval(), 10000u);
+
+  return res;
+}
+
+tion_request_info_t state_request_info(uint16_t type, const void *data, size_t size) {
+  return {.rsp_type = 0x11, .request_id = 0, .idempotent = false};
+}
+
+bool test_component_link() {
+  bool res = true;
+
+  Tion3sApi api;
+  TestTionApiComponent c(&api);
+  TionRequestTracker requests;
+  requests.set_request_info(state_request_info);
+  c.set_request_tracker(&requests);
+  c.set_state_timeout(3000);
+  esphome::test_set_millis(1000);
+
+  // state timeout is reported as soon as the tracker gives up the state request
+  c.test_timeout(true);
+  c.test_state_check(0x11);
+  requests.track(0x10, nullptr, 0);
+  res &= cloak::check_data("waiting", c.has_state(), true);
+  esphome::test_set_millis(1000 + TionRequestTracker::REQUEST_TIMEOUT);
+  requests.loop();
+  res &= cloak::check_data("state lost", c.has_state(), false);
+  res &= cloak::check_data("link", c.status_has_warning(), false);
+
+  for (int i = 1; i < TionRequestTracker::LINK_LOST_TIMEOUTS; i++) {
+    requests.track(0x10, nullptr, 0);
+    esphome::test_set_millis(1000 + TionRequestTracker::REQUEST_TIMEOUT * (i + 1));
+    requests.loop();
+  }
+  res &= cloak::check_data("link lost", c.status_has_warning(), true);
+
+  // local settings change is not a breezer response
+  api.set_auto_min_fan_speed(2);
+  res &= cloak::check_data("local change", c.status_has_warning(), true);
+
+  c.test_state(STATE_FIELD_FAN_SPEED);
+  res &= cloak::check_data("link restored", c.status_has_warning(), false);
+  res &= cloak::check_data("state restored", c.has_state(), true);
+  c.test_timeout(false);
+
+  return res;
+}
+
+// Breezer which applies written state on response.
+class BatchTestApi : public TionApiBase {
+ public:
+  BatchTestApi() {
+    this->traits_ = Tion3sApi().get_traits();
+    this->state_.initialized = true;
+    this->state_.power_state = true;
+    this->state_.fan_speed = 1;
+  }
+  void request_state() override {}
+  void write_state(TionStateCall *call) override {
+    this->written_ = this->make_write_state_(call);
+    if (this->write_suppressed_(this->written_)) {
+      return;
+    }
+    this->frames++;
+    this->state_written_(this->written_, 0);
+  }
+  void reset_filter() override {}
+
+  // sends state response, the first one after a write is requested before it
+  void respond(bool applied) {
+    if (applied) {
+      this->state_.copy_fields(this->written_, STATE_FIELD_WRITABLE);
+    }
+    this->notify_state_(0);
+  }
+
+  uint32_t frames{};
+
+ protected:
+  TionState written_{};
+};
+
+bool test_component_batch() {
+  bool res = true;
+
+  BatchTestApi api;
+  TestTionApiComponent c(&api);
+  c.set_batch_timeout(200);
+  c.set_state_timeout(3000);
+  esphome::test_set_millis(1000);
+
+  // changes of several entities are merged into a single write
+  c.test_timeout(true);
+  auto *call = c.make_call();
+  call->set_fan_speed(2);
+  call->perform();
+  esphome::test_set_millis(esphome::millis() + 150);
+  call = c.make_call();
+  call->set_sound_state(true);
+  call->perform();
+  res &= cloak::check_data("merged", api.frames, 0u);
+  esphome::test_set_millis(esphome::millis() + 50);
+  c.test_timeout(false);
+  res &= cloak::check_data("written", api.frames, 1u);
+  res &= cloak::check_data("send latency", c.get_send_latency().max(), 200u);
+
+  // final change of a single entity is written at once, but waits for the previous write
+  c.test_timeout(true);
+  call = c.make_call(true);
+  call->set_fan_speed(3);
+  call->perform();
+  res &= cloak::check_data("hold", api.frames, 1u);
+  esphome::test_set_millis(esphome::millis() + 300);
+  api.respond(false);
+  res &= cloak::check_data("not confirmed", api.frames, 1u);
+  api.respond(true);
+  res &= cloak::check_data("confirm latency", c.get_confirm_latency().max(), 500u);
+  res &= cloak::check_data("released", api.frames, 2u);
+  res &= cloak::check_data("released latency", c.get_send_latency().max(), 300u);
+
+  esphome::test_set_millis(esphome::millis() + 100);
+  api.respond(false);
+  api.respond(true);
+  call = c.make_call(true);
+  call->set_fan_speed(4);
+  call->perform();
+  res &= cloak::check_data("final", api.frames, 3u);
+  res &= cloak::check_data("latencies", c.get_send_latency().count(), 3u);
+  // 200 ms and 300 ms are in [200, 400) bucket, final write is in [0, 25)
+  res &= cloak::check_data("latency buckets", c.get_send_latency()[0] + c.get_send_latency()[4], 3u);
+  res &= cloak::check_data("percentile", c.get_send_latency().percentile(50), 400u);
+  c.test_timeout(false);
+
+  return res;
+}
+
+}  // namespace
+
+REGISTER_TEST(test_component_subscribers);
+REGISTER_TEST(test_component_adaptive_poll);
+REGISTER_TEST(test_component_batch);
+REGISTER_TEST(test_component_link);
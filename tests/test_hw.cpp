@@ -193,7 +193,7 @@ class Tion4sCompTest : public TionComponentTest<Tion4sApi> {
     api->on_state_fn.set<this_t, &this_t::on_state>(*this);
     api->on_heartbeat_fn.set<this_t, &this_t::on_heartbeat>(*this);
   }
-  void on_state(const TionState &state, uint32_t request_id) {}
+  void on_state(const TionState &state, uint32_t changes, uint32_t request_id) {}
   void on_heartbeat(uint8_t work_mode) { this->api_->send_heartbeat(); }
 };
 